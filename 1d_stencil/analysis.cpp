@@ -0,0 +1,171 @@
+#include "analysis.hpp"
+#include "options.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/threads.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+bool parse_analysis(std::string const& spec, unsigned& kinds)
+{
+    kinds = 0;
+
+    std::istringstream is(spec);
+    std::string name;
+    while (std::getline(is, name, ','))
+    {
+        if (name == "reductions")
+            kinds |= analysis_reductions;
+        else if (name == "histogram")
+            kinds |= analysis_histogram;
+        else if (name == "snapshot")
+            kinds |= analysis_snapshot;
+        else
+            return false;
+    }
+    return kinds != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+analysis::analysis(std::string const& filename, std::size_t max_in_flight)
+  : max_in_flight_((std::max)(max_in_flight, std::size_t(1)))
+  , in_flight_(0)
+  , skipped_(0)
+  , out_(filename)
+{
+    if (!out_)
+        std::cerr << "Unable to write analysis file: " << filename << std::endl;
+}
+
+analysis::~analysis()
+{
+    wait();
+    out_ << "skipped," << skipped_ << "\n";
+}
+
+bool analysis::submit(std::size_t t, std::vector<partition> const& space)
+{
+    // drop the futures of the time steps which have been analyzed already
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+                       [](hpx::future<void> const& f) { return f.is_ready(); }),
+        pending_.end());
+
+    if (in_flight_ >= max_in_flight_)
+    {
+        ++skipped_;
+        return false;
+    }
+    ++in_flight_;
+
+    // The partitions of the time step may not have been computed yet, the
+    // analysis starts only once all of them are available.
+    pending_.push_back(hpx::dataflow(
+        hpx::launch::async_policy(hpx::threads::thread_priority_low),
+        [this, t](std::vector<partition> space) {
+            std::vector<partition_data> data;
+            data.reserve(space.size());
+            for (partition const& p : space)
+            {
+                data.push_back(
+                    p.get_data(partition_server::middle_partition).get());
+            }
+
+            analyze(t, data);
+            --in_flight_;
+        },
+        space));
+
+    return true;
+}
+
+void analysis::wait()
+{
+    hpx::wait_all(pending_);
+    pending_.clear();
+
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx_);
+    out_ << std::flush;
+}
+
+// Analyze the first member of ensemble runs only
+void analysis::analyze(std::size_t t, std::vector<partition_data> const& data)
+{
+    double sum = 0.;
+    double energy = 0.;
+    double min_value = (std::numeric_limits<double>::max)();
+    double max_value = std::numeric_limits<double>::lowest();
+    for (partition_data const& d : data)
+    {
+        for (std::size_t j = 0; j != d.size(); ++j)
+        {
+            double const u = d[j];
+            sum += u;
+            energy += u * u;
+            min_value = (std::min)(min_value, u);
+            max_value = (std::max)(max_value, u);
+        }
+    }
+
+    std::ostringstream os;
+
+    if (analysis_kinds & analysis_reductions)
+    {
+        hpx::util::format_to(os, "reductions,{},{:.14g},{:.14g},{:.14g},{:.14g}\n",
+            t, sum, energy, min_value, max_value);
+    }
+
+    if (analysis_kinds & analysis_histogram)
+    {
+        std::size_t const bins = (std::max)(histogram_bins, std::size_t(1));
+        std::vector<std::size_t> counts(bins, 0);
+
+        double const width = (max_value - min_value) / bins;
+        for (partition_data const& d : data)
+        {
+            for (std::size_t j = 0; j != d.size(); ++j)
+            {
+                std::size_t bin = width > 0. ?
+                    std::size_t((d[j] - min_value) / width) :
+                    0;
+                ++counts[(std::min)(bin, bins - 1)];
+            }
+        }
+
+        hpx::util::format_to(os, "histogram,{},{:.14g},{:.14g}", t, min_value,
+            max_value);
+        for (std::size_t c : counts)
+            hpx::util::format_to(os, ",{}", c);
+        os << "\n";
+    }
+
+    if (analysis_kinds & analysis_snapshot)
+    {
+        std::size_t const stride = (std::max)(snapshot_stride, std::size_t(1));
+
+        hpx::util::format_to(os, "snapshot,{},{}", t, stride);
+        std::size_t offset = 0;    // index of the first point of 'd'
+        for (partition_data const& d : data)
+        {
+            std::size_t j = (stride - offset % stride) % stride;
+            for (/**/; j < d.size(); j += stride)
+            {
+                hpx::util::format_to(os, ",{:.14g}", d[j]);
+            }
+            offset += d.size();
+        }
+        os << "\n";
+    }
+
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx_);
+    out_ << os.str();
+}
@@ -0,0 +1,76 @@
+#if !defined(ANALYSIS_HPP_)
+#define ANALYSIS_HPP_
+
+#include "partition.hpp"
+#include "partition_data.hpp"
+
+#include <hpx/include/lcos.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Analyses which can be selected with --analysis
+enum analysis_kind : unsigned
+{
+    analysis_reductions = 0x1,    // sum, energy (sum of squares), min, max
+    analysis_histogram = 0x2,     // histogram over [min, max]
+    analysis_snapshot = 0x4       // every n-th grid point
+};
+
+// Convert the value of the --analysis command line option (a comma separated
+// list of 'reductions', 'histogram', and 'snapshot'), returns false if the
+// list contains an unknown analysis.
+bool parse_analysis(std::string const& spec, unsigned& kinds);
+
+///////////////////////////////////////////////////////////////////////////////
+// In-situ analysis of the local partitions running alongside the time step
+// loop. The analysis of a time step waits for the partitions of that step to
+// become available, accesses their data without copying (as long as they are
+// local), and runs with low priority, i.e. on otherwise idle cores. The
+// results are appended to a csv file, one per locality:
+//
+//  reductions,<step>,<sum>,<energy>,<min>,<max>
+//  histogram,<step>,<min>,<max>,<count>,<count>,...
+//  snapshot,<step>,<stride>,<value>,<value>,...
+//
+// At most 'max_in_flight' time steps are being analyzed at any time, which
+// bounds the number of partitions kept alive by the analysis. Further time
+// steps are skipped (and counted) instead of stalling the solver.
+class analysis
+{
+public:
+    analysis(std::string const& filename, std::size_t max_in_flight);
+    ~analysis();
+
+    analysis(analysis const&) = delete;
+    analysis& operator=(analysis const&) = delete;
+
+    // Analyze the state 'space' of the local partitions at time step 't',
+    // returns false if the time step was skipped.
+    bool submit(std::size_t t, std::vector<partition> const& space);
+
+    // Wait for all submitted time steps to be analyzed
+    void wait();
+
+    std::size_t skipped() const
+    {
+        return skipped_;
+    }
+
+private:
+    void analyze(std::size_t t, std::vector<partition_data> const& data);
+
+    std::size_t max_in_flight_;
+    std::atomic<std::size_t> in_flight_;
+    std::atomic<std::size_t> skipped_;
+    std::vector<hpx::future<void>> pending_;
+
+    hpx::lcos::local::mutex mtx_;
+    std::ofstream out_;
+};
+
+#endif    // ANALYSIS_HPP_
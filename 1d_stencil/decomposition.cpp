@@ -0,0 +1,127 @@
+#include "decomposition.hpp"
+#include "options.hpp"
+
+#include <hpx/hpx.hpp>
+#include <hpx/include/parallel_for_loop.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Measure how many grid points per second this locality updates
+double calibrate()
+{
+    std::size_t const size = 1 << 20;
+    std::size_t const steps = 10;
+
+    double const c = k * dt / (dx * dx);
+    std::vector<double> u(size, 1.0), w(size, 1.0);
+
+    std::uint64_t t = hpx::util::high_resolution_clock::now();
+
+    for (std::size_t s = 0; s != steps; ++s)
+    {
+        hpx::parallel::for_loop(hpx::parallel::execution::par,
+            std::size_t(1), size - 1, [&](std::size_t i) {
+                w[i] = u[i] + c * (u[i - 1] - 2 * u[i] + u[i + 1]);
+            });
+        std::swap(u, w);
+    }
+
+    std::uint64_t elapsed = hpx::util::high_resolution_clock::now() - t;
+
+    return double(size * steps) / ((std::max)(elapsed, std::uint64_t(1)) / 1e9);
+}
+
+bool locality_weight(
+    std::string const& spec, std::size_t num_localities, double& weight)
+{
+    if (spec == "equal")
+    {
+        weight = 1.0;
+        return true;
+    }
+    if (spec == "threads")
+    {
+        weight = double(hpx::get_num_worker_threads());
+        return true;
+    }
+    if (spec == "calibrate")
+    {
+        weight = calibrate();
+        return true;
+    }
+
+    // list of weights, one per locality
+    std::vector<double> weights;
+    std::istringstream strm(spec);
+    std::string item;
+    while (std::getline(strm, item, ','))
+    {
+        try
+        {
+            weights.push_back(std::stod(item));
+        }
+        catch (std::exception const&)
+        {
+            return false;
+        }
+        if (weights.back() <= 0)
+            return false;
+    }
+
+    if (weights.size() != num_localities)
+        return false;
+
+    weight = weights[hpx::get_locality_id()];
+    return true;
+}
+
+std::vector<std::size_t> decompose(
+    std::size_t np, std::vector<double> const& weights)
+{
+    std::size_t const nl = weights.size();
+    HPX_ASSERT(np >= nl);
+
+    // every locality gets one partition, the remaining ones are distributed
+    // proportionally to the weights (largest remainder method)
+    std::vector<std::size_t> result(nl, 1);
+
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    std::size_t const rest = np - nl;
+
+    std::vector<std::pair<double, std::size_t>> remainders;
+    remainders.reserve(nl);
+
+    std::size_t assigned = 0;
+    for (std::size_t i = 0; i != nl; ++i)
+    {
+        double share =
+            total > 0 ? rest * weights[i] / total : double(rest) / nl;
+        std::size_t whole = (std::min)(std::size_t(share), rest - assigned);
+
+        result[i] += whole;
+        assigned += whole;
+        remainders.emplace_back(share - whole, i);
+    }
+
+    std::stable_sort(remainders.begin(), remainders.end(),
+        [](std::pair<double, std::size_t> const& lhs,
+            std::pair<double, std::size_t> const& rhs) {
+            return lhs.first > rhs.first;
+        });
+
+    for (std::size_t i = 0; assigned != rest; ++i, ++assigned)
+    {
+        ++result[remainders[i % nl].second];
+    }
+
+    return result;
+}
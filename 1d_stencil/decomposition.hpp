@@ -0,0 +1,26 @@
+#if !defined(DECOMPOSITION_HPP_)
+#define DECOMPOSITION_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Determine the weight of this locality as given by the --weights command
+// line option:
+//
+//  equal       all localities get the same weight (default)
+//  threads     the number of worker threads of the locality
+//  calibrate   the measured speed of a short run of the heat operator
+//  w0,w1,...   the given weight for each of the localities
+//
+// Returns false if the specification is invalid.
+bool locality_weight(
+    std::string const& spec, std::size_t num_localities, double& weight);
+
+// Distribute 'np' partitions over the localities proportionally to their
+// weights. Every locality gets at least one partition.
+std::vector<std::size_t> decompose(
+    std::size_t np, std::vector<double> const& weights);
+
+#endif    // DECOMPOSITION_HPP_
@@ -1,7 +1,9 @@
 #if !defined(DEFS_HPP_)
 #define DEFS_HPP_
 
-constexpr char const* stepper_basename = "/1d_stencil_8/stepper/";
+constexpr char const* bootstrap_basename = "/1d_stencil_8/bootstrap/";
 constexpr char const* gather_basename = "/1d_stencil_8/gather/";
+constexpr char const* statistics_basename = "/1d_stencil_8/statistics/";
+constexpr char const* elastic_basename = "/1d_stencil_8/elastic/";
 
 #endif    // DEFS_HPP_
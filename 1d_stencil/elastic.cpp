@@ -0,0 +1,267 @@
+#include "elastic.hpp"
+#include "decomposition.hpp"
+#include "migrate_concurrently.hpp"
+#include "options.hpp"
+
+#include <hpx/hpx.hpp>
+#include <hpx/include/naming.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+bool parse_membership_changes(std::string const& spec, bool join,
+    std::vector<membership_change>& changes)
+{
+    std::istringstream is(spec);
+    std::string entry;
+    while (std::getline(is, entry, ','))
+    {
+        std::string::size_type colon = entry.find(':');
+        if (colon == std::string::npos)
+            return false;
+
+        try
+        {
+            membership_change c;
+            c.locality = std::uint32_t(std::stoul(entry.substr(0, colon)));
+            c.step = std::stoull(entry.substr(colon + 1));
+            c.join = join;
+            changes.push_back(c);
+        }
+        catch (std::exception const&)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    hpx::lcos::local::spinlock changes_mtx;
+    std::vector<membership_change> announced_changes;
+
+    // Remove and return the changes which are due at time step 't'
+    std::vector<membership_change> due_changes(std::size_t t)
+    {
+        std::lock_guard<hpx::lcos::local::spinlock> l(changes_mtx);
+
+        auto it = std::stable_partition(announced_changes.begin(),
+            announced_changes.end(),
+            [t](membership_change const& c) { return c.step > t; });
+
+        std::vector<membership_change> due(it, announced_changes.end());
+        announced_changes.erase(it, announced_changes.end());
+        return due;
+    }
+
+    // Localities which announced to join are not active initially
+    bool joins_later(std::uint32_t locality)
+    {
+        std::lock_guard<hpx::lcos::local::spinlock> l(changes_mtx);
+        return std::any_of(announced_changes.begin(), announced_changes.end(),
+            [locality](membership_change const& c) {
+                return c.join && c.locality == locality;
+            });
+    }
+
+    std::vector<std::size_t> decompose_active(std::size_t np,
+        std::vector<stepper_info> const& steppers,
+        std::vector<std::uint32_t> const& active)
+    {
+        std::vector<double> weights;
+        weights.reserve(active.size());
+        for (std::uint32_t l : active)
+        {
+            weights.push_back(steppers[l].weight);
+        }
+        return decompose(np, weights);
+    }
+
+    // Move every partition to the locality it has been assigned to, the
+    // partitions keep their global order. Partitions which already live on
+    // their target stay where they are, all others are migrated concurrently.
+    void redistribute(stepper_server::space& field,
+        std::vector<std::uint32_t> const& active,
+        std::vector<std::size_t> const& counts)
+    {
+        std::vector<hpx::id_type> targets;
+        targets.reserve(field.size());
+
+        std::vector<hpx::future<hpx::id_type>> where;
+        where.reserve(field.size());
+
+        std::size_t g = 0;
+        for (std::size_t k = 0; k != active.size(); ++k)
+        {
+            hpx::id_type target =
+                hpx::naming::get_id_from_locality_id(active[k]);
+
+            for (std::size_t i = 0; i != counts[k]; ++i, ++g)
+            {
+                targets.push_back(target);
+                where.push_back(hpx::get_colocation_id(field[g].get_id()));
+            }
+        }
+
+        std::vector<std::size_t> indices;
+        std::vector<std::pair<partition, hpx::id_type>> moves;
+        for (std::size_t i = 0; i != where.size(); ++i)
+        {
+            if (where[i].get() != targets[i])
+            {
+                indices.push_back(i);
+                moves.emplace_back(field[i], targets[i]);
+            }
+        }
+
+        std::vector<partition> moved = migrate_concurrently(moves).get();
+        for (std::size_t i = 0; i != indices.size(); ++i)
+        {
+            field[indices[i]] = std::move(moved[i]);
+        }
+    }
+
+    // Wire up the active steppers into a ring
+    void rewire(std::vector<stepper_info> const& steppers,
+        std::vector<std::uint32_t> const& active)
+    {
+        std::size_t const n = active.size();
+
+        std::vector<hpx::future<void>> wired;
+        wired.reserve(n);
+        for (std::size_t k = 0; k != n; ++k)
+        {
+            wired.push_back(hpx::async(set_neighbors_action(),
+                steppers[active[k]].id,
+                steppers[active[stepper_server::idx(k, -1, n)]].id,
+                steppers[active[stepper_server::idx(k, +1, n)]].id));
+        }
+        hpx::wait_all(wired);
+    }
+}
+
+void announce_membership_change(membership_change change)
+{
+    std::lock_guard<hpx::lcos::local::spinlock> l(changes_mtx);
+    announced_changes.push_back(change);
+}
+
+HPX_REGISTER_ACTION(announce_membership_change_action);
+
+///////////////////////////////////////////////////////////////////////////////
+stepper_server::space run_elastic(std::vector<stepper_info> const& steppers,
+    std::size_t nx, std::size_t np, std::size_t nt, std::uint64_t nd,
+    std::vector<std::size_t>& initial)
+{
+    std::uint32_t const nl = std::uint32_t(steppers.size());
+
+    std::vector<std::uint32_t> active;
+    for (std::uint32_t l = 0; l != nl; ++l)
+    {
+        if (!joins_later(l))
+            active.push_back(l);
+    }
+    if (active.empty())
+    {
+        HPX_THROW_EXCEPTION(hpx::bad_parameter, "run_elastic",
+            "at least one locality has to be active initially");
+    }
+
+    // Initial conditions: f(0, i) = i on the locality owning partition 'i'
+    std::vector<std::size_t> counts = decompose_active(np, steppers, active);
+
+    initial.assign(nl, 0);
+    stepper_server::space field;
+    field.reserve(np);
+    for (std::size_t k = 0; k != active.size(); ++k)
+    {
+        initial[active[k]] = counts[k];
+
+        hpx::id_type where = hpx::naming::get_id_from_locality_id(active[k]);
+        for (std::size_t i = 0; i != counts[k]; ++i)
+        {
+            if (ensemble.empty())
+            {
+                field.push_back(partition(where, nx, double(i)));
+            }
+            else
+            {
+                field.push_back(partition(
+                    where, stepper_server::ensemble_initial_data(nx, i)));
+            }
+        }
+    }
+
+    rewire(steppers, active);
+
+    for (std::size_t t0 = 0; t0 < nt; /**/)
+    {
+        // apply the membership changes which are due
+        bool changed = false;
+        for (membership_change const& c : due_changes(t0))
+        {
+            auto it = std::lower_bound(active.begin(), active.end(),
+                c.locality);
+            bool const is_active = it != active.end() && *it == c.locality;
+
+            if (c.join && !is_active && c.locality < nl)
+            {
+                active.insert(it, c.locality);
+                changed = true;
+            }
+            else if (!c.join && is_active && active.size() > 1)
+            {
+                active.erase(it);
+                changed = true;
+            }
+        }
+
+        if (changed)
+        {
+            counts = decompose_active(np, steppers, active);
+            redistribute(field, active, counts);
+            rewire(steppers, active);
+
+            hpx::util::format_to(std::cerr,
+                "time step {}: continuing on {} localities\n", t0,
+                active.size());
+        }
+
+        // run one epoch on all active localities
+        std::size_t const steps = (std::min)(elastic_epoch, nt - t0);
+
+        std::vector<hpx::future<stepper_server::space>> epoch;
+        epoch.reserve(active.size());
+
+        auto first = field.begin();
+        for (std::size_t k = 0; k != active.size(); ++k)
+        {
+            stepper_server::space local(first, first + counts[k]);
+            first += counts[k];
+
+            epoch.push_back(hpx::async(do_epoch_action(),
+                steppers[active[k]].id, std::move(local), t0, steps, nd));
+        }
+
+        field.clear();
+        for (hpx::future<stepper_server::space>& f : epoch)
+        {
+            stepper_server::space local = f.get();
+            field.insert(field.end(), local.begin(), local.end());
+        }
+
+        t0 += steps;
+    }
+
+    return field;
+}
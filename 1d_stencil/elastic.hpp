@@ -0,0 +1,60 @@
+#if !defined(ELASTIC_HPP_)
+#define ELASTIC_HPP_
+
+#include "stepper_server.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/serialization.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Elastic runs (see --elastic-epoch)
+//
+// The time steps are computed in epochs of a fixed number of steps. Locality
+// 0 drives all steppers through the epochs. Between two epochs it applies the
+// membership changes announced by the localities: a joining locality is
+// added to the set of active localities, a leaving one is removed. If the
+// set has changed, the partitions are distributed anew over the active
+// localities (keeping their global order), the partitions which changed
+// their owner are migrated, and the active steppers are rewired into a new
+// ring before the next epoch starts.
+
+// A locality announcing to join or leave the computation at time step 'step'
+struct membership_change
+{
+    std::uint32_t locality;
+    std::uint64_t step;
+    bool join;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        ar & locality & step & join;
+    }
+};
+
+// Convert the value of the --join or --leave command line option, a comma
+// separated list of <locality>:<step>. Returns false if the list is invalid.
+bool parse_membership_changes(std::string const& spec, bool join,
+    std::vector<membership_change>& changes);
+
+// Record a membership change on locality 0, this has to be invoked before
+// the steppers are created.
+void announce_membership_change(membership_change change);
+
+HPX_DEFINE_PLAIN_ACTION(
+    announce_membership_change, announce_membership_change_action);
+HPX_REGISTER_ACTION_DECLARATION(announce_membership_change_action);
+
+// Run all 'nt' time steps on locality 0, returns the final partitions in
+// their global order. 'initial' is set to the number of partitions each
+// locality started with, which defines the initial conditions.
+stepper_server::space run_elastic(std::vector<stepper_info> const& steppers,
+    std::size_t nx, std::size_t np, std::size_t nt, std::uint64_t nd,
+    std::vector<std::size_t>& initial);
+
+#endif    // ELASTIC_HPP_
@@ -0,0 +1,116 @@
+#include "fft.hpp"
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace {
+    using complex = std::complex<double>;
+
+    double const pi = 3.14159265358979323846;
+
+    bool is_power_of_two(std::size_t n)
+    {
+        return (n & (n - 1)) == 0;
+    }
+
+    // exp(sign * 2 pi i k / n), the angle is computed for every 'k' to
+    // avoid the rounding errors of a recurrence
+    complex root(std::size_t k, std::size_t n, double sign)
+    {
+        return std::polar(1.0, sign * 2 * pi * double(k) / double(n));
+    }
+
+    void radix2(complex* data, std::size_t n, bool inverse)
+    {
+        // bit reversal permutation
+        for (std::size_t i = 1, j = 0; i != n; ++i)
+        {
+            std::size_t bit = n >> 1;
+            for (/**/; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+
+            if (i < j)
+                std::swap(data[i], data[j]);
+        }
+
+        double const sign = inverse ? 1.0 : -1.0;
+
+        std::vector<complex> roots(n / 2);
+        for (std::size_t k = 0; k != n / 2; ++k)
+            roots[k] = root(k, n, sign);
+
+        for (std::size_t len = 2; len <= n; len <<= 1)
+        {
+            std::size_t const half = len / 2;
+            std::size_t const stride = n / len;
+            for (std::size_t i = 0; i != n; i += len)
+            {
+                for (std::size_t j = 0; j != half; ++j)
+                {
+                    complex const u = data[i + j];
+                    complex const v = data[i + j + half] * roots[j * stride];
+                    data[i + j] = u + v;
+                    data[i + j + half] = u - v;
+                }
+            }
+        }
+    }
+
+    // X[k] = w[k] * sum_j (x[j] * w[j]) * conj(w[k - j]) with the chirp
+    // w[j] = exp(-pi i j^2 / n), as j k = (j^2 + k^2 - (k - j)^2) / 2
+    void bluestein(complex* data, std::size_t n, bool inverse)
+    {
+        std::size_t m = 1;
+        while (m < 2 * n - 1)
+            m <<= 1;
+
+        double const sign = inverse ? 1.0 : -1.0;
+
+        // j^2 is reduced modulo 2n to keep the angles small
+        std::vector<complex> chirp(n);
+        for (std::size_t j = 0; j != n; ++j)
+        {
+            std::size_t const jj = (j * j) % (2 * n);
+            chirp[j] = std::polar(1.0, sign * pi * double(jj) / double(n));
+        }
+
+        std::vector<complex> a(m), b(m);
+        for (std::size_t j = 0; j != n; ++j)
+        {
+            a[j] = data[j] * chirp[j];
+        }
+        b[0] = std::conj(chirp[0]);
+        for (std::size_t j = 1; j != n; ++j)
+        {
+            b[j] = b[m - j] = std::conj(chirp[j]);
+        }
+
+        radix2(a.data(), m, false);
+        radix2(b.data(), m, false);
+        for (std::size_t j = 0; j != m; ++j)
+        {
+            a[j] *= b[j];
+        }
+        radix2(a.data(), m, true);
+
+        for (std::size_t k = 0; k != n; ++k)
+        {
+            data[k] = a[k] * chirp[k] / double(m);
+        }
+    }
+}
+
+void fft(std::complex<double>* data, std::size_t n, bool inverse)
+{
+    if (n <= 1)
+        return;
+
+    if (is_power_of_two(n))
+        radix2(data, n, inverse);
+    else
+        bluestein(data, n, inverse);
+}
@@ -0,0 +1,18 @@
+#if !defined(FFT_HPP_)
+#define FFT_HPP_
+
+#include <complex>
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+// Discrete Fourier transform of the 'n' values starting at 'data', in place:
+//
+//   X[k] = sum_j x[j] * exp(-2 pi i j k / n)     (inverse: +2 pi i)
+//
+// The inverse transform is not normalized, i.e. it has to be divided by 'n'.
+// Powers of two are transformed by an iterative radix-2 FFT, all other
+// lengths by Bluestein's algorithm (a convolution computed by radix-2 FFTs),
+// both take O(n log n) operations.
+void fft(std::complex<double>* data, std::size_t n, bool inverse = false);
+
+#endif    // FFT_HPP_
@@ -0,0 +1,127 @@
+#if !defined(HALO_MAILBOX_HPP_)
+#define HALO_MAILBOX_HPP_
+
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/threads.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// Counters shared by all mailboxes of this locality
+struct halo_mailbox_counters
+{
+    std::atomic<std::uint64_t> stores{0};      // values published
+    std::atomic<std::uint64_t> receives{0};    // values requested
+    std::atomic<std::uint64_t> waits{0};       // slot still in use, retried
+};
+
+inline halo_mailbox_counters& halo_mailbox_statistics()
+{
+    static halo_mailbox_counters counters;
+    return counters;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// A fixed capacity replacement for hpx::lcos::local::receive_buffer, which
+// keeps a map of promises keyed by the time step behind a mutex. The number
+// of time steps in flight is bounded by the depth of the dependency tree,
+// therefore a ring of 'capacity' slots indexed by 't % capacity' is
+// sufficient.
+//
+// Every slot serves one time step at a time. Its promise is set by
+// store_received and its future is handed out by receive; whichever of the
+// two comes second re-arms the slot for the time step 'capacity' steps
+// later. No locks are involved in finding a slot. If a value for a time
+// step arrives while its slot still serves an earlier time step, the
+// storing thread yields until the slot has been re-armed (counted as a
+// wait). receive has to be called in the order of the time steps.
+template <typename T>
+class halo_mailbox
+{
+private:
+    struct slot
+    {
+        std::atomic<std::size_t> step{0};    // time step served by this slot
+        std::atomic<int> done{0};            // store and receive finished
+        hpx::lcos::local::promise<T> promise;
+        hpx::future<T> future;
+    };
+
+public:
+    explicit halo_mailbox(std::size_t capacity)
+      : capacity_(capacity != 0 ? capacity : 1)
+      , slots_(new slot[capacity_])
+    {
+        for (std::size_t i = 0; i != capacity_; ++i)
+        {
+            arm(slots_[i], i);
+        }
+    }
+
+    halo_mailbox(halo_mailbox const&) = delete;
+    halo_mailbox& operator=(halo_mailbox const&) = delete;
+
+    void store_received(std::size_t t, T&& value)
+    {
+        slot& s = acquire(t);
+        s.promise.set_value(std::move(value));
+        ++halo_mailbox_statistics().stores;
+        release(s, t);
+    }
+
+    hpx::future<T> receive(std::size_t t)
+    {
+        slot& s = acquire(t);
+        hpx::future<T> f = std::move(s.future);
+        ++halo_mailbox_statistics().receives;
+        release(s, t);
+        return f;
+    }
+
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    void arm(slot& s, std::size_t t)
+    {
+        s.promise = hpx::lcos::local::promise<T>();
+        s.future = s.promise.get_future();
+        s.done.store(0, std::memory_order_relaxed);
+        s.step.store(t, std::memory_order_release);
+    }
+
+    // wait for the slot of time step 't' to serve this time step
+    slot& acquire(std::size_t t)
+    {
+        slot& s = slots_[t % capacity_];
+        if (s.step.load(std::memory_order_acquire) != t)
+        {
+            ++halo_mailbox_statistics().waits;
+            do
+            {
+                hpx::this_thread::yield();
+            } while (s.step.load(std::memory_order_acquire) != t);
+        }
+        return s;
+    }
+
+    // the second of store_received and receive re-arms the slot
+    void release(slot& s, std::size_t t)
+    {
+        if (s.done.fetch_add(1, std::memory_order_acq_rel) == 1)
+        {
+            arm(s, t + capacity_);
+        }
+    }
+
+    std::size_t capacity_;
+    std::unique_ptr<slot[]> slots_;
+};
+
+#endif    // HALO_MAILBOX_HPP_
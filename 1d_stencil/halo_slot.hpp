@@ -0,0 +1,107 @@
+#if !defined(HALO_SLOT_HPP_)
+#define HALO_SLOT_HPP_
+
+#include <hpx/include/async.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/util.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// The boundary element a partition receives from one of its neighbors in the
+// coroutine based time step loop (see heat_part_loop). Unlike
+// hpx::lcos::local::receive_buffer, nothing is allocated per time step: a
+// neighbor can be at most one time step ahead of its receiver (it needs the
+// receiver's boundary element of the next time step to proceed), therefore
+// two slots indexed by 't % 2' hold all values in flight.
+//
+// receive returns an awaitable which completes once the value of the given
+// time step has been stored. A suspended receiver is resumed on a new HPX
+// thread (resuming it on the storing thread would nest the loops of all
+// local partitions on one stack). Only one receiver may wait for a slot at a
+// time.
+template <typename T>
+class halo_slot
+{
+private:
+    using mutex_type = hpx::lcos::local::spinlock;
+
+    struct slot
+    {
+        T value;
+        bool full = false;
+        hpx::util::unique_function_nonser<void()> waiter;
+    };
+
+public:
+    halo_slot() = default;
+
+    halo_slot(halo_slot const&) = delete;
+    halo_slot& operator=(halo_slot const&) = delete;
+
+    void store_received(std::size_t t, T value)
+    {
+        slot& s = slots_[t % 2];
+
+        hpx::util::unique_function_nonser<void()> waiter;
+        {
+            std::lock_guard<mutex_type> l(mtx_);
+            HPX_ASSERT(!s.full);
+            s.value = std::move(value);
+            s.full = true;
+            std::swap(waiter, s.waiter);
+        }
+
+        if (waiter)
+            hpx::apply(std::move(waiter));
+    }
+
+    struct awaiter
+    {
+        halo_slot& self;
+        std::size_t t;
+
+        bool await_ready() const
+        {
+            return false;
+        }
+
+        // suspend only if the value has not been stored yet
+        template <typename Handle>
+        bool await_suspend(Handle h)
+        {
+            slot& s = self.slots_[t % 2];
+
+            std::lock_guard<mutex_type> l(self.mtx_);
+            if (s.full)
+                return false;
+
+            HPX_ASSERT(!s.waiter);
+            s.waiter = [h]() mutable { h.resume(); };
+            return true;
+        }
+
+        T await_resume()
+        {
+            slot& s = self.slots_[t % 2];
+
+            std::lock_guard<mutex_type> l(self.mtx_);
+            HPX_ASSERT(s.full);
+            s.full = false;
+            return std::move(s.value);
+        }
+    };
+
+    awaiter receive(std::size_t t)
+    {
+        return awaiter{*this, t};
+    }
+
+private:
+    mutex_type mtx_;
+    slot slots_[2];
+};
+
+#endif    // HALO_SLOT_HPP_
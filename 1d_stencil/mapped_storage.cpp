@@ -0,0 +1,127 @@
+#include "mapped_storage.hpp"
+
+#include <hpx/config.hpp>
+#include <hpx/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if !defined(HPX_WINDOWS)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if !defined(HPX_WINDOWS)
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    // madvise and msync require the address to be aligned to a page, the
+    // arrays passed in here may start anywhere inside of a mapping
+    std::uintptr_t align_down(void const* p, std::size_t& bytes)
+    {
+        static std::size_t const page_size = std::size_t(sysconf(_SC_PAGESIZE));
+
+        std::uintptr_t const addr = reinterpret_cast<std::uintptr_t>(p);
+        std::uintptr_t const aligned = addr & ~std::uintptr_t(page_size - 1);
+        bytes += addr - aligned;
+        return aligned;
+    }
+
+    void advise(void const* p, std::size_t bytes, int advice)
+    {
+        if (p == nullptr || bytes == 0)
+            return;
+
+        std::uintptr_t const addr = align_down(p, bytes);
+        madvise(reinterpret_cast<void*>(addr), bytes, advice);    // hint only
+    }
+}
+
+void* map_storage(std::string const& directory, std::size_t bytes)
+{
+    std::string name = directory + "/1d_stencil.XXXXXX";
+    std::vector<char> path(name.begin(), name.end());
+    path.push_back('\0');
+
+    int fd = mkstemp(path.data());
+    if (fd == -1)
+    {
+        HPX_THROW_EXCEPTION(hpx::out_of_memory, "map_storage",
+            "cannot create a file in " + directory + ": " +
+                std::strerror(errno));
+    }
+
+    // the mapping keeps the file alive
+    unlink(path.data());
+
+    if (ftruncate(fd, off_t(bytes)) != 0)
+    {
+        int const error = errno;
+        close(fd);
+        HPX_THROW_EXCEPTION(hpx::out_of_memory, "map_storage",
+            "cannot extend a file in " + directory + ": " +
+                std::strerror(error));
+    }
+
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int const error = errno;
+    close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        HPX_THROW_EXCEPTION(hpx::out_of_memory, "map_storage",
+            std::string("cannot map a file: ") + std::strerror(error));
+    }
+    return p;
+}
+
+void unmap_storage(void* p, std::size_t bytes)
+{
+    munmap(p, bytes);
+}
+
+void discard_storage(void* p, std::size_t bytes)
+{
+    // punch a hole into the file if the file system supports this
+#if defined(MADV_REMOVE)
+    std::size_t length = bytes;
+    std::uintptr_t const addr = align_down(p, length);
+    if (madvise(reinterpret_cast<void*>(addr), length, MADV_REMOVE) == 0)
+        return;
+#endif
+    advise(p, bytes, MADV_DONTNEED);
+}
+
+void prefetch_storage(void const* p, std::size_t bytes)
+{
+    advise(p, bytes, MADV_WILLNEED);
+}
+
+void write_back_storage(void const* p, std::size_t bytes)
+{
+    if (p == nullptr || bytes == 0)
+        return;
+
+    std::uintptr_t const addr = align_down(p, bytes);
+    msync(reinterpret_cast<void*>(addr), bytes, MS_ASYNC);    // hint only
+}
+
+#else
+
+///////////////////////////////////////////////////////////////////////////////
+void* map_storage(std::string const&, std::size_t)
+{
+    HPX_THROW_EXCEPTION(hpx::not_implemented, "map_storage",
+        "the out-of-core mode is not supported on this platform");
+    return nullptr;
+}
+
+void unmap_storage(void*, std::size_t) {}
+void discard_storage(void*, std::size_t) {}
+void prefetch_storage(void const*, std::size_t) {}
+void write_back_storage(void const*, std::size_t) {}
+
+#endif
@@ -0,0 +1,33 @@
+#if !defined(MAPPED_STORAGE_HPP_)
+#define MAPPED_STORAGE_HPP_
+
+#include <cstddef>
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////
+// Storage for the out-of-core mode (see --ooc-dir)
+//
+// Every array is backed by its own file in the given directory, which is
+// mapped into memory. The file is removed right after it has been created,
+// i.e. it disappears once the array has been unmapped (or the process has
+// terminated). The operating system keeps the recently used pages in memory
+// and writes the others back to disk, the hints below tell it which pages
+// are going to be needed soon and which ones are finished.
+
+// Create and map a file of 'bytes' bytes in 'directory', throws on failure
+void* map_storage(std::string const& directory, std::size_t bytes);
+
+// Unmap an array created by map_storage, this removes its file
+void unmap_storage(void* p, std::size_t bytes);
+
+// The contents of the array are not needed anymore (it is kept in the pool
+// of the allocator), drop its pages without writing them back
+void discard_storage(void* p, std::size_t bytes);
+
+// Start reading the array from disk, as it will be accessed soon
+void prefetch_storage(void const* p, std::size_t bytes);
+
+// Start writing the array back to disk without waiting for it to finish
+void write_back_storage(void const* p, std::size_t bytes);
+
+#endif    // MAPPED_STORAGE_HPP_
@@ -0,0 +1,158 @@
+// This benchmark compares the regular migration of a partition with the
+// streaming migration (partition::stream_migrate). For each state size it
+// reports the overall time needed to move the partition and the blackout
+// time, i.e. the longest time a concurrent reader had to wait for
+// get_data to return while the partition was being moved. Both kinds of
+// migration keep the global id of the partition, the reader keeps reading
+// from the same partition throughout.
+
+#include <hpx/hpx_init.hpp>
+
+#include "partition.hpp"
+#include "partition_server.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/hpx.hpp>
+#include <hpx/include/util.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Repeatedly read the left boundary element of the given partition and
+// record the longest time a single read took.
+struct reader
+{
+    explicit reader(partition p)
+      : current_(std::move(p))
+      , stop_(false)
+      , blackout_(0)
+    {
+        done_ = hpx::async([this]() { run(); });
+    }
+
+    // stop reading, returns the blackout time in [ns]
+    std::uint64_t stop()
+    {
+        stop_ = true;
+        done_.get();
+        return blackout_;
+    }
+
+private:
+    void run()
+    {
+        while (!stop_)
+        {
+            std::uint64_t t = hpx::util::high_resolution_clock::now();
+            current_.get_data(partition_server::left_partition).get();
+            std::uint64_t elapsed = hpx::util::high_resolution_clock::now() - t;
+
+            blackout_ = (std::max)(blackout_, elapsed);
+        }
+    }
+
+    partition current_;
+    std::atomic<bool> stop_;
+    std::uint64_t blackout_;
+    hpx::future<void> done_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+void print_result(std::size_t size, char const* mode, std::size_t chunk,
+    std::uint64_t elapsed, std::uint64_t blackout)
+{
+    hpx::util::format_to(std::cout, "{},{},{},{:.14g},{:.14g}\n",
+        size * sizeof(double), mode, chunk, elapsed / 1e9, blackout / 1e9)
+        << std::flush;
+}
+
+void benchmark_migrate(hpx::id_type target, std::size_t size)
+{
+    partition p(hpx::find_here(), size, 0.0);
+    p.get_data(partition_server::left_partition).wait();
+
+    reader r(p);
+
+    std::uint64_t t = hpx::util::high_resolution_clock::now();
+
+    partition moved(hpx::components::migrate(p, target));
+    moved.wait();
+
+    std::uint64_t elapsed = hpx::util::high_resolution_clock::now() - t;
+
+    print_result(size, "migrate", size, elapsed, r.stop());
+}
+
+void benchmark_stream(hpx::id_type target, std::size_t size, std::size_t chunk,
+    bool serve_reads)
+{
+    partition p(hpx::find_here(), size, 0.0);
+    p.get_data(partition_server::left_partition).wait();
+
+    reader r(p);
+
+    std::uint64_t t = hpx::util::high_resolution_clock::now();
+
+    partition moved = p.stream_migrate(target, chunk, serve_reads);
+    moved.wait();
+
+    std::uint64_t elapsed = hpx::util::high_resolution_clock::now() - t;
+
+    print_result(size, serve_reads ? "stream_serve_reads" : "stream", chunk,
+        elapsed, r.stop());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(boost::program_options::variables_map& vm)
+{
+    std::size_t min_size = vm["min-size"].as<std::size_t>();
+    std::size_t max_size = vm["max-size"].as<std::size_t>();
+    std::size_t chunk = vm["chunk"].as<std::size_t>();
+    bool serve_reads = vm.count("serve-reads") != 0;
+
+    // move the partitions to another locality, if available
+    std::vector<hpx::id_type> localities = hpx::find_remote_localities();
+    hpx::id_type target =
+        localities.empty() ? hpx::find_here() : localities.front();
+
+    if (!vm.count("no-header"))
+        std::cout << "State_Bytes,Mode,Chunk_Elements,Execution_Time_sec,"
+                     "Blackout_Time_sec\n"
+                  << std::flush;
+
+    for (std::size_t size = (std::max)(min_size, std::size_t(1));
+         size <= max_size; size *= 2)
+    {
+        benchmark_migrate(target, size);
+        benchmark_stream(target, size, chunk, serve_reads);
+    }
+
+    return hpx::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace boost::program_options;
+
+    options_description desc_commandline;
+    desc_commandline.add_options()
+        ("min-size", value<std::size_t>()->default_value(1024),
+         "Smallest number of elements of the migrated partition")
+        ("max-size", value<std::size_t>()->default_value(16 * 1024 * 1024),
+         "Largest number of elements of the migrated partition")
+        ("chunk", value<std::size_t>()->default_value(64 * 1024),
+         "Number of elements sent per chunk by the streaming migration")
+        ("serve-reads", "keep serving reads from the source partition while "
+         "the streaming migration sends the chunks")
+        ( "no-header", "do not print out the csv header row")
+    ;
+
+    return hpx::init(desc_commandline, argc, argv);
+}
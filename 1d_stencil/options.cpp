@@ -1,7 +1,155 @@
 #include "options.hpp"
 
+#include <hpx/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
 bool header = true; // print csv heading
 bool print_results = false;
 double k = 0.5;     // heat transfer coefficient
 double dt = 1.;     // time step
 double dx = 1.;     // grid spacing
+work_mode mode = work_mode::dataflow;
+std::size_t tile_steps = 8;
+std::size_t tile_size = 4096;
+bool numa_placement = false;
+bool boundary_priority = true;
+bool skip_quiescent = false;
+double activity_threshold = 0.0;
+bool copy_halos = false;
+bool report_statistics = false;
+bool validate = false;
+bool spectral_reference = false;
+std::size_t analysis_interval = 0;
+std::string analysis_file = "analysis";
+std::size_t analysis_queue = 4;
+unsigned analysis_kinds = 0;
+std::size_t histogram_bins = 16;
+std::size_t snapshot_stride = 1024;
+bool use_mailbox = false;
+std::size_t mailbox_capacity = 0;
+std::string ooc_directory;
+std::size_t ooc_prefetch = 2;
+std::size_t elastic_epoch = 0;
+std::vector<ensemble_member> ensemble;
+std::vector<double> ensemble_coefficients;
+bool migrate_on_access = false;
+std::size_t affinity_window = 32;
+double affinity_share = 0.75;
+std::size_t affinity_sustain = 2;
+std::size_t affinity_cooldown = 8;
+bool account_traffic = false;
+std::atomic<bool> tracing(false);
+std::size_t trace_buffer_size = 65536;
+
+bool parse_work_mode(std::string const& name, work_mode& m)
+{
+    if (name == "dataflow")
+    {
+        m = work_mode::dataflow;
+        return true;
+    }
+    if (name == "replay")
+    {
+        m = work_mode::replay;
+        return true;
+    }
+    if (name == "tiled")
+    {
+        m = work_mode::tiled;
+        return true;
+    }
+    if (name == "spectral")
+    {
+        m = work_mode::spectral;
+        return true;
+    }
+#if defined(HPX_HAVE_AWAIT)
+    if (name == "coroutine")
+    {
+        m = work_mode::coroutine;
+        return true;
+    }
+#endif
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Expand one parameter specification into one value per member
+static bool parse_member_values(std::string const& spec, double default_value,
+    std::size_t members, std::vector<double>& values)
+{
+    values.clear();
+    try
+    {
+        if (spec.empty())
+        {
+            values.assign(members, default_value);
+            return true;
+        }
+
+        std::string::size_type colon = spec.find(':');
+        if (colon != std::string::npos)
+        {
+            double first = std::stod(spec.substr(0, colon));
+            double last = std::stod(spec.substr(colon + 1));
+            for (std::size_t m = 0; m != members; ++m)
+            {
+                values.push_back(members == 1 ?
+                        first :
+                        first + (last - first) * double(m) / (members - 1));
+            }
+            return true;
+        }
+
+        std::istringstream is(spec);
+        std::string value;
+        while (std::getline(is, value, ','))
+        {
+            values.push_back(std::stod(value));
+        }
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+
+    if (values.size() == 1)
+        values.assign(members, values[0]);
+    return values.size() == members;
+}
+
+bool parse_ensemble(std::size_t members, std::string const& k_spec,
+    std::string const& dt_spec, std::string const& scale_spec)
+{
+    ensemble.clear();
+    ensemble_coefficients.clear();
+
+    if (members == 0)
+        return false;
+    if (members == 1 && k_spec.empty() && dt_spec.empty() &&
+        scale_spec.empty())
+    {
+        return true;    // not an ensemble run
+    }
+
+    std::vector<double> ks, dts, scales;
+    if (!parse_member_values(k_spec, k, members, ks) ||
+        !parse_member_values(dt_spec, dt, members, dts) ||
+        !parse_member_values(scale_spec, 1.0, members, scales))
+    {
+        return false;
+    }
+
+    for (std::size_t m = 0; m != members; ++m)
+    {
+        ensemble.push_back(ensemble_member{ks[m], dts[m], scales[m]});
+        ensemble_coefficients.push_back(ks[m] * dts[m] / (dx * dx));
+    }
+    return true;
+}
@@ -1,6 +1,43 @@
 #if !defined(OPTIONS_HPP_)
 #define OPTIONS_HPP_
 
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementations of the time step loop (see stepper_server::do_work)
+enum class work_mode
+{
+    dataflow,     // nested dataflow, one task graph per time step
+    coroutine,    // one coroutine per partition looping over all time steps
+    replay,       // time step graph captured once and replayed every step
+    tiled,        // several time steps per pass over cache sized blocks
+    spectral      // all time steps at once through a distributed FFT
+};
+
+// Convert the value of the --mode command line option, returns false if the
+// given mode is unknown or not supported by this build.
+bool parse_work_mode(std::string const& name, work_mode& m);
+
+///////////////////////////////////////////////////////////////////////////////
+// Parameters of one member of an ensemble run (see --members)
+struct ensemble_member
+{
+    double k;        // heat transfer coefficient
+    double dt;       // time step
+    double scale;    // factor applied to the initial conditions
+};
+
+// Set up the parameters of 'members' ensemble members. Every specification
+// is either a single value used for all members, a comma separated list of
+// one value per member, or a range 'first:last' spread evenly over the
+// members. An empty specification of 'k' or 'dt' selects the value given by
+// --k or --dt. Returns false if a specification is invalid.
+bool parse_ensemble(std::size_t members, std::string const& k_spec,
+    std::string const& dt_spec, std::string const& scale_spec);
+
 ///////////////////////////////////////////////////////////////////////////////
 // Command-line variables
 extern bool header;   // print csv heading
@@ -8,5 +45,37 @@ extern bool print_results;
 extern double k;      // heat transfer coefficient
 extern double dt;     // time step
 extern double dx;     // grid spacing
+extern work_mode mode;    // time step loop implementation
+extern std::size_t tile_steps;    // time steps per tile (tiled mode)
+extern std::size_t tile_size;     // grid points per tile (tiled mode)
+extern bool numa_placement;       // bind partitions to NUMA domains
+extern bool boundary_priority;    // boundary partitions run first
+extern bool skip_quiescent;       // forward partitions which do not change
+extern double activity_threshold;    // largest change considered quiescent
+extern bool copy_halos;           // boundary elements do not share buffers
+extern bool report_statistics;    // print per locality statistics
+extern bool validate;             // compare with the reference solution
+extern bool spectral_reference;   // validate against spectral_solution
+extern std::size_t analysis_interval;    // analyze every n-th step, 0: never
+extern std::string analysis_file;        // prefix of the analysis files
+extern std::size_t analysis_queue;       // time steps analyzed concurrently
+extern unsigned analysis_kinds;          // see analysis_kind
+extern std::size_t histogram_bins;
+extern std::size_t snapshot_stride;      // distance of the snapshot points
+extern bool use_mailbox;          // receive through halo_mailbox
+extern std::size_t mailbox_capacity;    // time steps per halo_mailbox
+extern std::string ooc_directory;    // out-of-core mode if not empty
+extern std::size_t ooc_prefetch;     // partitions prefetched ahead
+extern std::size_t elastic_epoch;    // time steps per epoch, 0: not elastic
+extern std::vector<ensemble_member> ensemble;    // empty: single simulation
+extern std::vector<double> ensemble_coefficients;    // k * dt / (dx * dx)
+extern bool migrate_on_access;    // partitions follow their callers
+extern std::size_t affinity_window;     // see affinity_policy
+extern double affinity_share;
+extern std::size_t affinity_sustain;
+extern std::size_t affinity_cooldown;
+extern bool account_traffic;      // record messages (see traffic.hpp)
+extern std::atomic<bool> tracing;    // record trace events (see trace.hpp)
+extern std::size_t trace_buffer_size;    // trace events per worker thread
 
-#endif // OPTIONS_HPP_
\ No newline at end of file
+#endif // OPTIONS_HPP_
@@ -3,6 +3,17 @@
 
 #include "partition_server.hpp"
 
+#include <hpx/runtime/agas/addressing_service.hpp>
+#include <hpx/runtime/agas/interface.hpp>
+#include <hpx/runtime/get_ptr.hpp>
+#include <hpx/runtime/naming/address.hpp>
+#include <hpx/runtime/naming/name.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
 ///////////////////////////////////////////////////////////////////////////////
 // This is a client side helper class allowing to hide some of the tedious
 // boilerplate while referencing a remote partition.
@@ -39,8 +50,98 @@ struct partition : hpx::components::client_base<partition, partition_server>
     // This is a pure helper function hiding the async.
     hpx::future<partition_data> get_data(partition_server::partition_type t) const
     {
+        if (std::shared_ptr<partition_server> p = get_local_ptr())
+            return hpx::make_ready_future(p->get_data(t));
+
+        // the reply is accounted by the locality serving the request
+        std::uint32_t const here = hpx::get_locality_id();
+        if (account_traffic)
+            record_request(t, here);
+
         partition_server::get_data_action act;
-        return hpx::async(act, get_id(), t);
+        return hpx::async(act, get_id(), t, here);
+    }
+
+    // Create the partition holding 'next' in the next time step, see
+    // partition_server::successor.
+    partition successor(partition_data const& next) const
+    {
+        if (std::shared_ptr<partition_server> p = get_local_ptr())
+        {
+            return partition(
+                hpx::local_new<partition_server>(next, p->affinity()));
+        }
+
+        partition_server::successor_action act;
+        return partition(hpx::async(act, get_id(), next));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Return a pointer to the referenced partition_server if it lives on this
+    // locality, an empty pointer otherwise. The pointer pins the component,
+    // i.e. the component will not be migrated away as long as the pointer is
+    // held. It is therefore not cached by this client (which would pin the
+    // component for the lifetime of the client and all of its copies), the
+    // caller should hold it only as long as it accesses the data.
+    std::shared_ptr<partition_server> get_local_ptr() const
+    {
+        hpx::id_type const& id = get_id();
+
+        hpx::error_code ec(hpx::lightweight);
+        if (!hpx::agas::is_local_address_cached(id, ec) || ec)
+            return std::shared_ptr<partition_server>();
+
+        std::shared_ptr<partition_server> p =
+            hpx::get_ptr<partition_server>(hpx::launch::sync, id, ec);
+        if (ec)
+            return std::shared_ptr<partition_server>();
+        return p;
+    }
+
+    // Migrate the referenced partition to the given locality.
+    partition migrate(hpx::id_type const& target) const
+    {
+        return partition(
+            hpx::components::migrate<partition_server>(get_id(), target));
+    }
+
+    // Move the referenced partition to 'target' by streaming its data in
+    // chunks of 'chunk_size' values to a staging area on 'target' first
+    // (see partition_server::stage_to). The partition is then migrated to
+    // 'target', which sends only the handle of the staged data, and keeps its
+    // global id. If 'serve_reads' is set, the partition can be read from
+    // while the chunks are being sent, otherwise the readers wait for the
+    // staging to complete.
+    partition stream_migrate(hpx::id_type const& target,
+        std::size_t chunk_size, bool serve_reads = true) const
+    {
+        hpx::id_type id = get_id();
+
+        partition_server::stage_to_action act;
+        return partition(
+            hpx::async(act, id, target, chunk_size, serve_reads)
+                .then([id, target](hpx::future<void>&& f) {
+                    f.get();    // propagate exceptions
+                    return hpx::components::migrate<partition_server>(
+                        id, target);
+                }));
+    }
+
+private:
+    // Account the request of get_data sent to the locality the referenced
+    // partition lives on according to the local AGAS cache (--traffic)
+    void record_request(
+        partition_server::partition_type t, std::uint32_t caller) const
+    {
+        hpx::naming::gid_type const& gid = get_id().get_gid();
+
+        std::uint32_t peer = any_locality;
+        hpx::naming::address addr;
+        if (hpx::naming::get_agas_client().resolve_cached(gid, addr))
+            peer = hpx::naming::get_locality_id_from_gid(addr.locality_);
+
+        record_traffic(traffic_kind::get_data_request, peer,
+            id_size() + serialized_size(t, caller));
     }
 };
 
@@ -1,14 +1,60 @@
 #if !defined(PARTITION_ALLOCATOR_HPP_)
 #define PARTITION_ALLOCATOR_HPP_
 
+#include "mapped_storage.hpp"
+
 #include <hpx/hpx.hpp>
+#include <hpx/include/resource_partitioner.hpp>
+#include <hpx/include/threads.hpp>
+#include <hpx/include/util.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <mutex>
 #include <stack>
+#include <string>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+// Statistics kept by the partition allocator
+struct partition_allocator_statistics
+{
+    std::uint64_t allocations = 0;      // calls to allocate
+    std::uint64_t hits = 0;             // allocations served from the pool
+    std::uint64_t misses = 0;           // allocations which needed new memory
+    std::uint64_t frees = 0;            // arrays released since the pool was full
+    std::uint64_t pooled_arrays = 0;    // arrays currently kept in the pool
+    std::uint64_t pooled_bytes = 0;     // bytes currently kept in the pool
+    std::uint64_t bytes_in_use = 0;     // bytes currently handed out
+    std::uint64_t high_water_mark = 0;  // maximum of bytes_in_use + pooled_bytes
+    std::uint64_t contentions = 0;      // number of contended lock acquisitions
+    std::uint64_t contention_time = 0;  // time spent waiting for the lock [ns]
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        ar & allocations & hits & misses & frees & pooled_arrays &
+            pooled_bytes & bytes_in_use & high_water_mark & contentions &
+            contention_time;
+    }
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 // Use a special allocator for the partition data to remove a major contention
-// point - the constant allocation and deallocation of the data arrays.
+// point - the constant allocation and deallocation of the data arrays. Freed
+// arrays are kept separately for each array size, an array is reused only
+// for an allocation of the same size.
+//
+// Optionally (see pool_per_numa_domain) the freed arrays are additionally
+// kept separately for every NUMA domain. An array is returned to the pool of
+// the domain it has been allocated on and is reused for allocations on this
+// domain only. As long as the arrays are allocated and first written by
+// threads running on one domain, their memory stays local to this domain.
+//
+// In the out-of-core mode (see map_to) the arrays are backed by memory mapped
+// files instead of the heap.
 template <typename T>
 struct partition_allocator
 {
@@ -18,47 +64,241 @@ private:
 public:
     partition_allocator(std::size_t max_size = std::size_t(-1))
       : max_size_(max_size)
+      , size_(0)
+      , min_mapped_bytes_(0)
+      , per_domain_(false)
     {
     }
 
     ~partition_allocator()
     {
         std::lock_guard<mutex_type> l(mtx_);
-        while (!heap_.empty())
+        for (auto& h : heap_)
         {
-            T* p = heap_.top();
-            heap_.pop();
-            delete[] p;
+            while (!h.second.empty())
+            {
+                T* p = h.second.top();
+                h.second.pop();
+                delete_array(p, h.first.second);
+            }
         }
     }
 
-    T* allocate(std::size_t n)
+    // Allocate an array of 'n' elements from the pool of 'domain' (see
+    // current_domain)
+    T* allocate(std::size_t n, std::size_t domain = 0)
     {
-        std::lock_guard<mutex_type> l(mtx_);
-        if (heap_.empty())
+        std::unique_lock<mutex_type> l = lock();
+
+        ++stats_.allocations;
+        stats_.bytes_in_use += n * sizeof(T);
+
+        auto it = heap_.find(std::make_pair(domain, n));
+        if (it == heap_.end() || it->second.empty())
         {
-            return new T[n];
+            ++stats_.misses;
+            stats_.high_water_mark = (std::max)(stats_.high_water_mark,
+                stats_.bytes_in_use + stats_.pooled_bytes);
+
+            // Creating a new array (in the out-of-core mode a memory mapped
+            // file) does not need the lock, other threads may use the pool
+            // in the meantime.
+            l.unlock();
+            try
+            {
+                return new_array(n);
+            }
+            catch (...)
+            {
+                l.lock();
+                stats_.bytes_in_use -= n * sizeof(T);
+                throw;
+            }
         }
 
-        T* next = heap_.top();
-        heap_.pop();
+        T* next = it->second.top();
+        it->second.pop();
+        --size_;
+
+        ++stats_.hits;
+        --stats_.pooled_arrays;
+        stats_.pooled_bytes -= n * sizeof(T);
         return next;
     }
 
-    void deallocate(T* p)
+    // Return the array 'p' of 'n' elements to the pool of the domain it has
+    // been allocated from
+    void deallocate(T* p, std::size_t n, std::size_t domain = 0)
+    {
+        // The system calls releasing the memory do not need the lock. The
+        // contents of a memory mapped array are discarded before the array
+        // is returned to the pool, another thread may take it from there
+        // right away.
+        if (mapped(n))
+            discard_storage(p, n * sizeof(T));
+
+        {
+            std::unique_lock<mutex_type> l = lock();
+
+            stats_.bytes_in_use -= n * sizeof(T);
+
+            if (max_size_ == static_cast<std::size_t>(-1) ||
+                size_ < max_size_)
+            {
+                heap_[std::make_pair(domain, n)].push(p);
+                ++size_;
+
+                ++stats_.pooled_arrays;
+                stats_.pooled_bytes += n * sizeof(T);
+                return;
+            }
+
+            ++stats_.frees;
+        }
+        delete_array(p, n);
+    }
+
+    // Allocate all arrays of at least 'min_bytes' bytes from memory mapped
+    // files created in 'directory' (out-of-core mode). This has to be done
+    // before the first array is allocated.
+    void map_to(std::string const& directory, std::size_t min_bytes)
+    {
+        std::lock_guard<mutex_type> l(mtx_);
+        if (stats_.bytes_in_use != 0 || size_ != 0)
+        {
+            HPX_THROW_EXCEPTION(hpx::invalid_status,
+                "partition_allocator::map_to",
+                "the allocator has already handed out arrays");
+        }
+        directory_ = directory;
+        min_mapped_bytes_ = min_bytes;
+    }
+
+    // Keep the freed arrays separately for every NUMA domain. This has to be
+    // done before the first array is allocated.
+    void pool_per_numa_domain()
+    {
+        std::lock_guard<mutex_type> l(mtx_);
+        if (stats_.bytes_in_use != 0 || size_ != 0)
+        {
+            HPX_THROW_EXCEPTION(hpx::invalid_status,
+                "partition_allocator::pool_per_numa_domain",
+                "the allocator has already handed out arrays");
+        }
+        per_domain_ = true;
+    }
+
+    // The pool the calling thread allocates from: the NUMA domain of the
+    // processing unit it runs on if the arrays are pooled per domain, 0
+    // otherwise
+    std::size_t current_domain() const
+    {
+        if (!per_domain_)
+            return 0;
+
+        std::size_t const thread = hpx::get_worker_thread_num();
+        if (thread == std::size_t(-1))
+            return 0;    // not an HPX worker thread
+
+        return hpx::threads::get_topology().get_numa_node_number(
+            hpx::resource::get_partitioner().get_pu_num(thread));
+    }
+
+    // Out-of-core mode: the array 'p' of 'n' elements will be accessed soon
+    void prefetch(T const* p, std::size_t n) const
+    {
+        if (mapped(n))
+            prefetch_storage(p, n * sizeof(T));
+    }
+
+    // Out-of-core mode: the array 'p' of 'n' elements has been written and
+    // will not be accessed for a while
+    void write_back(T const* p, std::size_t n) const
+    {
+        if (mapped(n))
+            write_back_storage(p, n * sizeof(T));
+    }
+
+    // Return a snapshot of the statistics
+    partition_allocator_statistics statistics()
     {
         std::lock_guard<mutex_type> l(mtx_);
-        if (max_size_ == static_cast<std::size_t>(-1) ||
-            heap_.size() < max_size_)
-            heap_.push(p);
+        return stats_;
+    }
+
+    // Return a single statistic, optionally resetting it. Only the given
+    // cumulative counter is reset, the high water mark is reset to the
+    // memory currently held and the gauges (pooled_arrays, pooled_bytes,
+    // bytes_in_use) are never reset.
+    std::uint64_t statistic(
+        std::uint64_t partition_allocator_statistics::*field, bool reset)
+    {
+        using stats = partition_allocator_statistics;
+
+        std::lock_guard<mutex_type> l(mtx_);
+        std::uint64_t const value = stats_.*field;
+        if (reset)
+        {
+            if (field == &stats::high_water_mark)
+            {
+                stats_.high_water_mark =
+                    stats_.bytes_in_use + stats_.pooled_bytes;
+            }
+            else if (field != &stats::pooled_arrays &&
+                field != &stats::pooled_bytes &&
+                field != &stats::bytes_in_use)
+            {
+                stats_.*field = 0;
+            }
+        }
+        return value;
+    }
+
+private:
+    bool mapped(std::size_t n) const
+    {
+        return !directory_.empty() && n * sizeof(T) >= min_mapped_bytes_;
+    }
+
+    T* new_array(std::size_t n)
+    {
+        if (mapped(n))
+            return static_cast<T*>(map_storage(directory_, n * sizeof(T)));
+        return new T[n];
+    }
+
+    void delete_array(T* p, std::size_t n)
+    {
+        if (mapped(n))
+            unmap_storage(p, n * sizeof(T));
         else
             delete[] p;
     }
 
-private:
+    // Acquire the lock, measuring the time spent waiting if it is contended
+    std::unique_lock<mutex_type> lock()
+    {
+        std::unique_lock<mutex_type> l(mtx_, std::try_to_lock);
+        if (!l.owns_lock())
+        {
+            std::uint64_t t = hpx::util::high_resolution_clock::now();
+            l.lock();
+            ++stats_.contentions;
+            stats_.contention_time +=
+                hpx::util::high_resolution_clock::now() - t;
+        }
+        return l;
+    }
+
     mutex_type mtx_;
     std::size_t max_size_;
-    std::stack<T*> heap_;
+    std::size_t size_;    // number of arrays kept in heap_
+    // the freed arrays keyed by their domain and size
+    std::map<std::pair<std::size_t, std::size_t>, std::stack<T*>> heap_;
+    partition_allocator_statistics stats_;
+    std::string directory_;    // out-of-core mode if not empty
+    std::size_t min_mapped_bytes_;
+    bool per_domain_;    // see pool_per_numa_domain
 };
 
 #endif    // PARTITION_ALLOCATOR_HPP_
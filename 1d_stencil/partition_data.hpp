@@ -3,11 +3,15 @@
 
 #include "partition_allocator.hpp"
 
+#include <cstddef>
+#include <limits>
+#include <string>
+
 struct partition_data
 {
-private:
     using buffer_type = hpx::serialization::serialize_buffer<double>;
 
+private:
     struct hold_reference
     {
         hold_reference(buffer_type const& data)
@@ -20,34 +24,54 @@ private:
         buffer_type data_;
     };
 
-    static void deallocate(double* p)
+    // return an array of the given size to the allocator
+    struct deallocate
     {
-        alloc_.deallocate(p);
-    }
+        void operator()(double* p) const
+        {
+            alloc_.deallocate(p, size_, domain_);
+        }
+
+        std::size_t size_;
+        std::size_t domain_;    // pool the array is returned to
+    };
 
     static partition_allocator<double> alloc_;
 
+    // Allocate an array from the pool of the calling thread's domain
+    static buffer_type allocate_buffer(std::size_t size)
+    {
+        std::size_t const domain = alloc_.current_domain();
+        return buffer_type(alloc_.allocate(size, domain), size,
+            buffer_type::take, deallocate{size, domain});
+    }
+
 public:
     partition_data()
       : size_(0)
+      , min_index_(0)
+      , members_(1)
+      , activity_(unknown_activity())
     {
     }
 
     // Create a new (uninitialized) partition of the given size.
     partition_data(std::size_t size)
-      : data_(alloc_.allocate(size), size, buffer_type::take,
-            &partition_data::deallocate)
+      : data_(allocate_buffer(size))
       , size_(size)
       , min_index_(0)
+      , members_(1)
+      , activity_(unknown_activity())
     {
     }
 
     // Create a new (initialized) partition of the given size.
     partition_data(std::size_t size, double initial_value)
-      : data_(alloc_.allocate(size), size, buffer_type::take,
-            &partition_data::deallocate)
+      : data_(allocate_buffer(size))
       , size_(size)
       , min_index_(0)
+      , members_(1)
+      , activity_(unknown_activity())
     {
         double base_value = double(initial_value * size);
         for (std::size_t i = 0; i != size; ++i)
@@ -58,15 +82,58 @@ public:
     // The proxy is assumed to refer to either the left or the right boundary
     // element.
     partition_data(partition_data const& base, std::size_t min_index)
-      : data_(base.data_.data() + min_index, 1, buffer_type::reference,
-            hold_reference(base.data_))
+      : data_(base.data_.data() + min_index * base.members_, base.members_,
+            buffer_type::reference, hold_reference(base.data_))
       ,    // keep referenced partition alive
       size_(base.size())
       , min_index_(min_index)
+      , members_(base.members_)
+      , activity_(base.activity_)
     {
         HPX_ASSERT(min_index < base.size());
     }
 
+    // Create a new (uninitialized) partition of the given size holding the
+    // values of 'members' ensemble members for every point. The values of
+    // all members at one point are stored next to each other, which allows
+    // to apply the stencil to all members at once.
+    static partition_data with_members(std::size_t size, std::size_t members)
+    {
+        partition_data result(size * members);
+        result.size_ = size;
+        result.members_ = members;
+        return result;
+    }
+
+    // Create a partition which holds a copy of the left or right boundary
+    // element of the given partition. Unlike the proxy above it does not
+    // keep the referenced partition alive.
+    static partition_data copy_element(
+        partition_data const& base, std::size_t min_index)
+    {
+        HPX_ASSERT(base.min_index_ == 0 && min_index < base.size());
+
+        partition_data result;
+        result.data_ = buffer_type(base.data_.data() + min_index * base.members_,
+            base.members_, buffer_type::copy);
+        result.size_ = base.size();
+        result.min_index_ = min_index;
+        result.members_ = base.members_;
+        result.activity_ = base.activity_;
+        return result;
+    }
+
+    // Return a buffer referring to 'count' values starting at 'offset'
+    // without copying them. The buffer keeps this partition alive while it
+    // is being used (e.g. while being serialized for a migration).
+    buffer_type chunk(std::size_t offset, std::size_t count) const
+    {
+        HPX_ASSERT(min_index_ == 0 && offset + count <= size_ * members_);
+        return buffer_type(data_.data() + offset, count, buffer_type::reference,
+            hold_reference(data_));
+    }
+
+    // Access the value of point 'idx' (of the first ensemble member)
     double& operator[](std::size_t idx)
     {
         return data_[index(idx)];
@@ -76,16 +143,101 @@ public:
         return data_[index(idx)];
     }
 
+    // Access the value of ensemble member 'member' at point 'idx'
+    double& operator()(std::size_t idx, std::size_t member)
+    {
+        HPX_ASSERT(member < members_);
+        return data_[index(idx) + member];
+    }
+    double operator()(std::size_t idx, std::size_t member) const
+    {
+        HPX_ASSERT(member < members_);
+        return data_[index(idx) + member];
+    }
+
+    // Access the underlying array of size() * members() values
+    double* data()
+    {
+        return data_.data();
+    }
+    double const* data() const
+    {
+        return data_.data();
+    }
+
     std::size_t size() const
     {
         return size_;
     }
 
+    // Number of ensemble members stored for every point
+    std::size_t members() const
+    {
+        return members_;
+    }
+
+    // Largest change of any value during the update which produced this
+    // partition (see --skip-quiescent). Partitions which have not been
+    // produced by an update report unknown_activity().
+    double activity() const
+    {
+        return activity_;
+    }
+    void activity(double value)
+    {
+        activity_ = value;
+    }
+
+    static constexpr double unknown_activity()
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // Out-of-core mode (see --ooc-dir): start reading the values of this
+    // partition from disk, or start writing them back
+    void prefetch() const
+    {
+        if (min_index_ == 0)
+            alloc_.prefetch(data_.data(), size_ * members_);
+    }
+    void write_back() const
+    {
+        if (min_index_ == 0)
+            alloc_.write_back(data_.data(), size_ * members_);
+    }
+
+    // Back the arrays of all partitions of at least 'min_bytes' bytes by
+    // memory mapped files in 'directory'
+    static void map_to(std::string const& directory, std::size_t min_bytes)
+    {
+        alloc_.map_to(directory, min_bytes);
+    }
+
+    // Pool the arrays of the partitions per NUMA domain (see --numa)
+    static void pool_per_numa_domain()
+    {
+        alloc_.pool_per_numa_domain();
+    }
+
+    // Return the statistics of the allocator used for all partitions
+    static partition_allocator_statistics allocator_statistics()
+    {
+        return alloc_.statistics();
+    }
+
+    // Return a single statistic of the allocator, see
+    // partition_allocator::statistic
+    static std::uint64_t allocator_statistic(
+        std::uint64_t partition_allocator_statistics::*field, bool reset)
+    {
+        return alloc_.statistic(field, reset);
+    }
+
 private:
     std::size_t index(std::size_t idx) const
     {
         HPX_ASSERT(idx >= min_index_ && idx < size_);
-        return idx - min_index_;
+        return (idx - min_index_) * members_;
     }
 
     // Serialization support: even if all of the code below runs on one
@@ -96,13 +248,15 @@ private:
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int version)
     {
-        ar & data_ & size_ & min_index_;
+        ar & data_ & size_ & min_index_ & members_ & activity_;
     }
 
 private:
     buffer_type data_;
     std::size_t size_;
     std::size_t min_index_;
+    std::size_t members_;
+    double activity_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
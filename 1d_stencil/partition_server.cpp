@@ -2,6 +2,185 @@
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/naming.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Number of chunks a streaming migration keeps in flight.
+constexpr std::size_t stream_window = 4;
+
+void partition_server::track_access(std::uint32_t caller) const
+{
+    std::uint32_t const here = hpx::get_locality_id();
+    if (caller == hpx::naming::invalid_locality_id)
+        caller = here;
+
+    affinity_policy const policy{affinity_window, affinity_share,
+        affinity_sustain, affinity_cooldown};
+
+    std::uint32_t const target = affinity_.record(caller, here, policy);
+    if (target != hpx::naming::invalid_locality_id)
+        migrate_to_caller<partition_server>(get_id(), target);
+}
+
+void partition_server::record_reply(partition_type t, std::uint32_t caller,
+    partition_data const& reply) const
+{
+    traffic_kind kind = traffic_kind::get_data_middle;
+    switch (t)
+    {
+    case left_partition:
+        kind = traffic_kind::get_data_left;
+        break;
+
+    case middle_partition:
+        kind = traffic_kind::get_data_middle;
+        break;
+
+    case right_partition:
+        kind = traffic_kind::get_data_right;
+        break;
+
+    default:
+        HPX_ASSERT(false);
+        break;
+    }
+    record_traffic(kind, caller, serialized_size(reply));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The staging area of the streaming migrations targeting this locality. The
+// staged arrays are allocated up front, the chunks are written into disjoint
+// ranges of them without holding the lock.
+namespace {
+    hpx::lcos::local::spinlock staging_mtx;
+    std::uint64_t next_staging_handle = 0;
+    std::map<std::uint64_t, partition_data> staging;
+
+    partition_data find_staged(std::uint64_t handle)
+    {
+        std::lock_guard<hpx::lcos::local::spinlock> l(staging_mtx);
+        auto it = staging.find(handle);
+        HPX_ASSERT(it != staging.end());
+        return it->second;
+    }
+}
+
+std::uint64_t stage_begin(std::size_t size, std::size_t members)
+{
+    partition_data data = partition_data::with_members(size, members);
+
+    std::lock_guard<hpx::lcos::local::spinlock> l(staging_mtx);
+    std::uint64_t handle = next_staging_handle++;
+    staging.emplace(handle, std::move(data));
+    return handle;
+}
+
+HPX_PLAIN_ACTION(stage_begin, stage_begin_action);
+
+void stage_chunk(std::uint64_t handle, std::size_t offset,
+    partition_data::buffer_type chunk)
+{
+    partition_data data = find_staged(handle);
+    std::copy(chunk.data(), chunk.data() + chunk.size(), data.data() + offset);
+}
+
+HPX_PLAIN_ACTION(stage_chunk, stage_chunk_action);
+
+partition_data stage_take(std::uint64_t handle)
+{
+    std::lock_guard<hpx::lcos::local::spinlock> l(staging_mtx);
+    auto it = staging.find(handle);
+    HPX_ASSERT(it != staging.end());
+
+    partition_data data = std::move(it->second);
+    staging.erase(it);
+    return data;
+}
+
+HPX_PLAIN_ACTION(stage_take, stage_take_action);
+
+void partition_server::stage_to(
+    hpx::id_type target, std::size_t chunk_size, bool serve_reads)
+{
+    std::size_t const size = data_.size() * data_.members();
+    std::uint64_t handle =
+        hpx::async(stage_begin_action(), target, data_.size(), data_.members())
+            .get();
+
+    if (!serve_reads)
+        gate_.close();
+
+    if (chunk_size == 0)
+        chunk_size = (std::max)(size, std::size_t(1));
+
+    // limit the number of chunks in flight
+    hpx::lcos::local::sliding_semaphore sem(stream_window);
+
+    std::vector<hpx::future<void>> chunks;
+    chunks.reserve((size + chunk_size - 1) / chunk_size);
+
+    for (std::size_t offset = 0, k = 0; offset < size; offset += chunk_size, ++k)
+    {
+        std::size_t count = (std::min)(chunk_size, size - offset);
+
+        partition_data::buffer_type chunk = data_.chunk(offset, count);
+        if (account_traffic)
+        {
+            record_traffic(traffic_kind::store_chunk,
+                hpx::naming::get_locality_id_from_id(target),
+                serialized_size(handle, offset, chunk));
+        }
+
+        hpx::future<void> sent = hpx::async(
+            stage_chunk_action(), target, handle, offset, std::move(chunk));
+
+        chunks.push_back(sent.then([&sem, k](hpx::future<void>&& f) {
+            sem.signal(k);
+            f.get();    // propagate exceptions
+        }));
+
+        sem.wait(k);
+    }
+
+    // propagate the failure of any of the chunks to the caller, the staged
+    // data is dropped in this case
+    std::vector<hpx::future<void>> sent =
+        hpx::when_all(std::move(chunks)).get();
+    gate_.open();
+    for (hpx::future<void>& f : sent)
+    {
+        if (f.has_exception())
+        {
+            hpx::apply(stage_take_action(), target, handle);
+            f.get();
+        }
+    }
+
+    staged_locality_ = hpx::naming::get_locality_id_from_id(target);
+    staged_handle_ = handle;
+}
+
+// The staged data normally lives on the locality the partition is migrated
+// to. If the partition has been migrated elsewhere meanwhile (e.g. by the
+// migrate-on-access policy), the data is fetched from the staging locality.
+partition_data partition_server::take_staged(
+    std::uint32_t locality, std::uint64_t handle)
+{
+    if (locality == hpx::get_locality_id())
+        return stage_take(handle);
+
+    return hpx::async(stage_take_action(),
+        hpx::naming::get_id_from_locality_id(locality), handle).get();
+}
 
 // The macros below are necessary to generate the code required for exposing
 // our partition type remotely.
@@ -12,3 +191,5 @@ using partition_server_type = hpx::components::component<partition_server>;
 HPX_REGISTER_COMPONENT(partition_server_type, partition_server);
 
 HPX_REGISTER_ACTION(get_data_action);
+HPX_REGISTER_ACTION(successor_action);
+HPX_REGISTER_ACTION(stage_to_action);
@@ -1,15 +1,79 @@
 #if !defined(PARTITION_SERVER_HPP_)
 #define PARTITION_SERVER_HPP_
 
+#include "affinity.hpp"
+#include "options.hpp"
 #include "partition_data.hpp"
+#include "traffic.hpp"
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/naming.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 
 template <typename T>
 using migratable_component_base =
     hpx::components::migration_support<hpx::components::component_base<T>>;
 
+///////////////////////////////////////////////////////////////////////////////
+// Holds back the readers of a partition while it is closed, see
+// partition_server::stage_to. Copies (e.g. the instance created by a
+// migration) start out open.
+class read_gate
+{
+    using mutex_type = hpx::lcos::local::spinlock;
+
+public:
+    read_gate()
+      : closed_(false)
+    {
+    }
+    read_gate(read_gate const&)
+      : closed_(false)
+    {
+    }
+    read_gate& operator=(read_gate const&)
+    {
+        return *this;
+    }
+
+    void close()
+    {
+        std::lock_guard<mutex_type> l(mtx_);
+        closed_ = true;
+    }
+
+    void open()
+    {
+        {
+            std::lock_guard<mutex_type> l(mtx_);
+            closed_ = false;
+        }
+        cond_.notify_all();
+    }
+
+    // Return immediately if the gate is open, wait for it to be opened
+    // otherwise
+    void pass() const
+    {
+        if (!closed_)
+            return;
+
+        std::unique_lock<mutex_type> l(mtx_);
+        cond_.wait(l, [this]() { return !closed_; });
+    }
+
+private:
+    mutable mutex_type mtx_;
+    mutable hpx::lcos::local::condition_variable_any cond_;
+    std::atomic<bool> closed_;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // This is the server side representation of the data. We expose this as a HPX
 // component which allows for it to be created and accessed remotely through
@@ -31,6 +95,15 @@ struct partition_server : migratable_component_base<partition_server>
     {
     }
 
+    // A successor inherits the access history of its predecessor (see
+    // successor)
+    partition_server(
+        partition_data const& data, affinity_tracker const& history)
+      : data_(data)
+      , affinity_(history)
+    {
+    }
+
     partition_server(std::size_t size, double initial_value)
       : data_(size, initial_value)
     {
@@ -39,18 +112,160 @@ struct partition_server : migratable_component_base<partition_server>
     // Access data. The parameter specifies what part of the data should be
     // accessed. As long as the result is used locally, no data is copied,
     // however as soon as the result is requested from another locality only
-    // the minimally required amount of data will go over the wire.
-    partition_data get_data(partition_type t) const
+    // the minimally required amount of data will go over the wire. If
+    // copy_halos is set, the boundary elements are returned as copies, which
+    // does not keep this partition's data alive.
+    //
+    // 'caller' is the locality the data is requested from, which is counted
+    // by the migrate-on-access policy. It defaults to this locality, i.e. to
+    // an access through a local pointer.
+    partition_data get_data(partition_type t,
+        std::uint32_t caller = hpx::naming::invalid_locality_id) const
+    {
+        gate_.pass();
+
+        if (migrate_on_access)
+            track_access(caller);
+
+        partition_data result = select_data(t);
+        if (account_traffic && caller != hpx::naming::invalid_locality_id)
+            record_reply(t, caller, result);
+        return result;
+    }
+
+    // Overwrite the value of a single element partition. The coroutine based
+    // time step loop reuses its boundary partitions this way (see
+    // heat_part_loop), it makes sure they are not read meanwhile.
+    void store_value(double value)
+    {
+        HPX_ASSERT(data_.size() == 1 && data_.members() == 1);
+        data_[0] = value;
+    }
+
+    // Out-of-core mode: hints for the data of this partition, see
+    // partition_data
+    void prefetch() const
+    {
+        data_.prefetch();
+    }
+    void write_back() const
+    {
+        data_.write_back();
+    }
+
+    // Every member function which has to be invoked remotely needs to be
+    // wrapped into a component action. The macro below defines a new type
+    // 'get_data_action' which represents the (possibly remote) member function
+    // partition::get_data().
+    HPX_DEFINE_COMPONENT_DIRECT_ACTION(partition_server, get_data);
+
+    // Create the partition of the next time step on this locality. It
+    // inherits the access history of this partition, the sequence of
+    // partitions holding the same part of the grid is therefore treated as a
+    // single component by the migrate-on-access policy.
+    hpx::id_type successor(partition_data const& next) const
+    {
+        return hpx::local_new<partition_server>(next, affinity_).get();
+    }
+
+    HPX_DEFINE_COMPONENT_ACTION(partition_server, successor);
+
+    affinity_tracker const& affinity() const
+    {
+        return affinity_;
+    }
+
+    // First half of a streaming migration: copy the data to a staging area
+    // on 'target' in chunks of 'chunk_size' values. Up to a fixed number of
+    // chunks are in flight at any time, which overlaps the serialization of
+    // one chunk with the transfer of the previous ones. If 'serve_reads' is
+    // set, get_data keeps being served from this instance meanwhile,
+    // otherwise it is held back until all chunks have arrived.
+    //
+    // The second half is a regular migration of this component to 'target'
+    // (see partition::stream_migrate), which sends only the handle of the
+    // staged data and therefore keeps the global id of the partition. It
+    // can't be started from here as the migration waits for all actions
+    // running on this instance to finish.
+    void stage_to(
+        hpx::id_type target, std::size_t chunk_size, bool serve_reads);
+
+    HPX_DEFINE_COMPONENT_ACTION(partition_server, stage_to);
+
+    // A partition_server is serialized only when it is migrated. If its
+    // data has been staged by stage_to, only the handle of the staged data is
+    // sent along.
+    template <typename Archive>
+    void save(Archive& ar, unsigned version) const
+    {
+        std::size_t const begin = ar.bytes_written();
+
+        bool const staged =
+            staged_locality_ != hpx::naming::invalid_locality_id;
+        ar & staged;
+        if (staged)
+        {
+            double const activity = data_.activity();
+            ar & staged_locality_ & staged_handle_ & activity;
+        }
+        else
+        {
+            ar & data_;
+        }
+        ar & affinity_;
+
+        if (!ar.is_preprocessing())
+        {
+            record_traffic(traffic_kind::migrate, any_locality,
+                ar.bytes_written() - begin);
+        }
+    }
+
+    template <typename Archive>
+    void load(Archive& ar, unsigned version)
+    {
+        bool staged = false;
+        ar & staged;
+        if (staged)
+        {
+            std::uint32_t locality = 0;
+            std::uint64_t handle = 0;
+            double activity = 0;
+            ar & locality & handle & activity;
+
+            data_ = take_staged(locality, handle);
+            data_.activity(activity);
+        }
+        else
+        {
+            ar & data_;
+        }
+        ar & affinity_;
+    }
+
+    HPX_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+    // Count the access from 'caller' and migrate this partition once a
+    // remote locality dominates its accesses (--migrate-on-access)
+    void track_access(std::uint32_t caller) const;
+
+    // Return the part of the data requested by get_data
+    partition_data select_data(partition_type t) const
     {
         switch (t)
         {
         case left_partition:
+            if (copy_halos)
+                return partition_data::copy_element(data_, data_.size() - 1);
             return partition_data(data_, data_.size() - 1);
 
         case middle_partition:
             break;
 
         case right_partition:
+            if (copy_halos)
+                return partition_data::copy_element(data_, 0);
             return partition_data(data_, 0);
 
         default:
@@ -60,20 +275,22 @@ struct partition_server : migratable_component_base<partition_server>
         return data_;
     }
 
-    // Every member function which has to be invoked remotely needs to be
-    // wrapped into a component action. The macro below defines a new type
-    // 'get_data_action' which represents the (possibly remote) member function
-    // partition::get_data().
-    HPX_DEFINE_COMPONENT_DIRECT_ACTION(partition_server, get_data);
+    // Account the reply of get_data sent to 'caller' (--traffic)
+    void record_reply(partition_type t, std::uint32_t caller,
+        partition_data const& reply) const;
 
-    template <typename Archive>
-    void serialize(Archive& ar, unsigned version)
-    {
-        ar & data_;
-    }
+    // Remove the data staged on 'locality' from the staging area and return
+    // it, see stage_to
+    static partition_data take_staged(
+        std::uint32_t locality, std::uint64_t handle);
 
-private:
     partition_data data_;
+    mutable affinity_tracker affinity_;
+
+    // Where the data has been staged by stage_to, if at all
+    std::uint32_t staged_locality_ = hpx::naming::invalid_locality_id;
+    std::uint64_t staged_handle_ = 0;
+    read_gate gate_;
 };
 
 // HPX_REGISTER_ACTION() exposes the component member function for remote
@@ -81,4 +298,10 @@ private:
 using get_data_action = partition_server::get_data_action;
 HPX_REGISTER_ACTION_DECLARATION(get_data_action);
 
+using successor_action = partition_server::successor_action;
+HPX_REGISTER_ACTION_DECLARATION(successor_action);
+
+using stage_to_action = partition_server::stage_to_action;
+HPX_REGISTER_ACTION_DECLARATION(stage_to_action);
+
 #endif    // PARTITION_SERVER_HPP_
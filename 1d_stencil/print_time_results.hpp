@@ -22,23 +22,39 @@ void print_time_results(
     , std::uint64_t nx
     , std::uint64_t np
     , std::uint64_t nt
+    , std::uint64_t members
+    , std::uint64_t startup
+    , std::uint64_t teardown
+    , double max_error      // negative if the solution was not validated
     , bool header
 )
 {
     if (header)
         std::cout << "Localities,OS_Threads,Execution_Time_sec,"
-        "Points_per_Partition,Partitions,Time_Steps\n"
+        "Points_per_Partition,Partitions,Time_Steps,"
+        "Startup_Time_sec,Teardown_Time_sec,Points_per_sec,Max_Error,"
+        "Members\n"
         << std::flush;
 
+    // grid point updates per second (of all ensemble members)
+    double const points_per_sec = elapsed != 0 ?
+        double(nx) * np * nt * members / (elapsed / 1e9) :
+        0.;
+    std::string const error_str =
+        max_error >= 0 ? hpx::util::format("{:.6g}", max_error) : "";
+
     std::string const locs_str = hpx::util::format("{},", num_localities);
     std::string const threads_str = hpx::util::format("{},", num_os_threads);
     std::string const nx_str = hpx::util::format("{},", nx);
     std::string const np_str = hpx::util::format("{},", np);
-    std::string const nt_str = hpx::util::format("{} ", nt);
+    std::string const nt_str = hpx::util::format("{},", nt);
 
-    hpx::util::format_to(std::cout, "{:-6} {:-6} {:.14g}, {:-21} {:-21} {:-21}\n",
+    hpx::util::format_to(std::cout,
+        "{:-6} {:-6} {:.14g}, {:-21} {:-21} {:-21} {:.14g}, {:.14g}, "
+        "{:.14g}, {}, {}\n",
         locs_str, threads_str, elapsed / 1e9, nx_str, np_str,
-        nt_str) << std::flush;
+        nt_str, startup / 1e9, teardown / 1e9, points_per_sec,
+        error_str, members) << std::flush;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
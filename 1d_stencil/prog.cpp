@@ -10,13 +10,20 @@
 
 #include <hpx/hpx_init.hpp>
 
+#include "decomposition.hpp"
+#include "elastic.hpp"
 #include "options.hpp"
 #include "partition.hpp"
 #include "partition_data.hpp"
 #include "partition_server.hpp"
 #include "print_time_results.hpp"
+#include "reference.hpp"
+#include "service.hpp"
+#include "statistics.hpp"
 #include "stepper.hpp"
 #include "stepper_server.hpp"
+#include "trace.hpp"
+#include "traffic.hpp"
 
 #include <hpx/hpx.hpp>
 #include <hpx/lcos/gather.hpp>
@@ -25,16 +32,22 @@
 
 #include <boost/shared_array.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
-void do_all_work(std::uint64_t nt, std::uint64_t nx, std::uint64_t np,
-    std::uint64_t nd)
+// Returns false if the solution has been validated and differs from the
+// reference solution by more than 'tolerance'.
+bool do_all_work(std::uint64_t nt, std::uint64_t nx, std::uint64_t np,
+    std::uint64_t nd, double weight, std::uint64_t memory_budget,
+    std::string const& trace_file, std::string const& traffic_file,
+    double tolerance)
 {
     std::vector<hpx::id_type> localities = hpx::find_all_localities();
     std::size_t nl = localities.size();    // Number of localities
@@ -43,18 +56,67 @@ void do_all_work(std::uint64_t nt, std::uint64_t nx, std::uint64_t np,
     {
         std::cout << "The number of partitions should not be smaller than "
                      "the number of localities" << std::endl;
-        return;
+        return true;
     }
 
-    // Create the local stepper instance, register it
-    stepper step(nl);
+    // Create the local stepper instance and wire it up with its neighbors
+    std::uint64_t t = hpx::util::high_resolution_clock::now();
+
+    std::unique_ptr<stepper> step(new stepper(nl, np, weight));
+
+    // Number of partitions assigned to each of the localities
+    std::vector<std::size_t> partitions = step->partitions();
+
+    std::uint64_t const startup = hpx::util::high_resolution_clock::now() - t;
+
+    std::size_t const local_np = partitions[hpx::get_locality_id()];
+
+    // Derive the depth of the dependency tree from the memory budget. Every
+    // time step in flight keeps one generation of the local partitions alive
+    // in addition to the two generations referenced by the stepper. Every
+    // grid point holds one value per ensemble member.
+    if (memory_budget != 0)
+    {
+        std::uint64_t const members = ensemble.empty() ? 1 : ensemble.size();
+        std::uint64_t const generation =
+            local_np * nx * members * sizeof(double);
+        std::uint64_t const generations = memory_budget / generation;
+        nd = generations > 3 ? generations - 2 : 1;
+    }
+
+    // All steppers have been wired up at this point, which makes the start
+    // of tracing roughly simultaneous on all localities.
+    if (!trace_file.empty())
+        start_tracing();
 
     // Measure execution time.
-    std::uint64_t t = hpx::util::high_resolution_clock::now();
+    t = hpx::util::high_resolution_clock::now();
 
     // Perform all work and wait for it to finish
-    hpx::future<stepper_server::space> result =
-        step.do_work(np / nl, nx, nt, nd);
+    hpx::future<stepper_server::space> result;
+    if (elastic_epoch == 0)
+    {
+        result = step->do_work(local_np, nx, nt, nd);
+    }
+    else
+    {
+        // Locality 0 drives all steppers and ends up with all partitions,
+        // the partitions initially assigned to each of the localities define
+        // the initial conditions. The other localities have to keep their
+        // steppers alive until the run has finished.
+        if (0 == hpx::get_locality_id())
+        {
+            result = hpx::make_ready_future(run_elastic(
+                step->steppers(), nx, np, nt, nd, partitions));
+        }
+        else
+        {
+            result = hpx::make_ready_future(stepper_server::space());
+        }
+        hpx::lcos::barrier(elastic_basename, nl).wait();
+    }
+
+    bool success = true;
 
     // Gather results from all localities
     if (0 == hpx::get_locality_id())
@@ -79,25 +141,155 @@ void do_all_work(std::uint64_t nt, std::uint64_t nx, std::uint64_t np,
         // Print the solution at time-step 'nt'.
         if (print_results)
         {
+            std::size_t offset = 0;
             for (std::size_t i = 0; i != nl; ++i)
             {
                 stepper_server::space const& s = solution[i];
                 for (std::size_t j = 0; j != s.size(); ++j)
                 {
-                    std::cout << "U[" << i*(s.size()) + j << "] = "
+                    std::cout << "U[" << offset + j << "] = "
                         << s[j].get_data(partition_server::middle_partition).get()
                         << std::endl;
                 }
+                offset += s.size();
+            }
+        }
+
+        // Compare the solution at time-step 'nt' with the serial reference
+        // implementation.
+        double error = -1.0;
+        if (validate)
+        {
+            std::vector<partition_data> data;
+            for (stepper_server::space const& s : solution)
+            {
+                for (partition const& p : s)
+                {
+                    data.push_back(
+                        p.get_data(partition_server::middle_partition).get());
+                }
+            }
+
+            // every member of an ensemble is compared separately
+            std::size_t const members = ensemble.empty() ? 1 : ensemble.size();
+            error = 0.0;
+            for (std::size_t q = 0; q != members; ++q)
+            {
+                std::vector<double> u;
+                u.reserve(np * nx);
+                for (partition_data const& d : data)
+                {
+                    for (std::size_t j = 0; j != d.size(); ++j)
+                    {
+                        u.push_back(d(j, q));
+                    }
+                }
+
+                double const c = ensemble.empty() ?
+                    k * dt / (dx * dx) :
+                    ensemble_coefficients[q];
+                double const scale = ensemble.empty() ? 1.0 : ensemble[q].scale;
+
+                std::vector<double> const reference = spectral_reference ?
+                    spectral_solution(partitions, nx, nt, c, scale) :
+                    reference_solution(partitions, nx, nt, c, scale);
+                error = (std::max)(error, max_error(reference, u));
             }
         }
 
+        // Measure the time needed to tear down the stepper
+        t = hpx::util::high_resolution_clock::now();
+        step.reset();
+        std::uint64_t const teardown =
+            hpx::util::high_resolution_clock::now() - t;
+
         print_time_results(std::uint32_t(nl), num_worker_threads, elapsed,
-            nx, np, nt, header);
+            nx, np, nt, ensemble.empty() ? 1 : ensemble.size(), startup,
+            teardown, error, header);
+
+        if (error > tolerance)
+        {
+            std::cerr << "Validation failed: the maximum relative error "
+                      << error << " exceeds the tolerance " << tolerance
+                      << std::endl;
+            success = false;
+        }
+
+        if (report_statistics)
+        {
+            std::vector<locality_statistics> statistics =
+                hpx::lcos::gather_here(statistics_basename,
+                    hpx::make_ready_future(collect_statistics()), nl)
+                    .get();
+
+            print_statistics(statistics, header);
+        }
+
+        // All work has completed, collect the trace events from all
+        // localities.
+        if (!trace_file.empty())
+        {
+            std::vector<hpx::future<std::vector<trace_event>>> traces;
+            for (hpx::id_type const& locality : localities)
+            {
+                traces.push_back(
+                    hpx::async(collect_trace_action(), locality));
+            }
+
+            std::vector<std::vector<trace_event>> events;
+            for (hpx::future<std::vector<trace_event>>& f : traces)
+            {
+                events.push_back(f.get());
+            }
+
+            write_trace(trace_file, events);
+        }
+
+        // Collect the messages recorded by all localities.
+        if (account_traffic)
+        {
+            std::vector<hpx::future<std::vector<traffic_record>>> records;
+            for (hpx::id_type const& locality : localities)
+            {
+                records.push_back(
+                    hpx::async(collect_traffic_action(), locality));
+            }
+
+            std::vector<std::vector<traffic_record>> traffic;
+            for (hpx::future<std::vector<traffic_record>>& f : records)
+            {
+                traffic.push_back(f.get());
+            }
+
+            print_traffic(traffic, nt, header, traffic_file);
+        }
     }
     else
     {
+        // only the ids of the final partitions are sent to locality 0
+        if (account_traffic)
+        {
+            result = result.then(hpx::launch::sync,
+                [](hpx::future<stepper_server::space>&& f) {
+                    stepper_server::space s = f.get();
+                    record_traffic(traffic_kind::gather, 0,
+                        serialized_size(s.size()) + s.size() * id_size());
+                    return s;
+                });
+        }
+
         hpx::lcos::gather_there(gather_basename, std::move(result)).wait();
+
+        if (report_statistics)
+        {
+            step.reset();
+            hpx::lcos::gather_there(statistics_basename,
+                hpx::make_ready_future(collect_statistics()))
+                .wait();
+        }
     }
+
+    return success;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -113,9 +305,223 @@ int hpx_main(boost::program_options::variables_map& vm)
     if (vm.count("results"))
         print_results = true;
 
-    do_all_work(nt, nx, np, nd);
+    if (vm.count("numa"))
+        numa_placement = true;
+    if (vm.count("no-boundary-priority"))
+        boundary_priority = false;
+    if (vm.count("skip-quiescent"))
+        skip_quiescent = true;
+    if (vm.count("copy-halos"))
+        copy_halos = true;
+    if (vm.count("statistics"))
+        report_statistics = true;
+    if (vm.count("migrate-on-access"))
+        migrate_on_access = true;
 
-    return hpx::finalize();
+    // The neighbors run at most about 'nd' time steps ahead, leave room for
+    // twice as many to avoid having to wait for a slot of the mailbox.
+    if (vm.count("mailbox"))
+    {
+        use_mailbox = true;
+        mailbox_capacity = 2 * (nd + 2);
+    }
+
+    // Memory budget per locality (in bytes).
+    std::uint64_t memory_budget = vm["memory-budget"].as<std::uint64_t>();
+
+    if (!parse_work_mode(vm["mode"].as<std::string>(), mode))
+    {
+        std::cout << "Unknown or unsupported time step loop implementation: "
+                  << vm["mode"].as<std::string>() << std::endl;
+        return hpx::finalize();
+    }
+
+    // Out-of-core mode, this has to be set up before the first partition is
+    // created
+    if (!ooc_directory.empty())
+    {
+        if (mode != work_mode::dataflow)
+        {
+            std::cout << "The out-of-core mode is supported by the dataflow "
+                         "implementation only" << std::endl;
+            return hpx::finalize();
+        }
+        partition_data::map_to(
+            ooc_directory, vm["ooc-min-size"].as<std::size_t>());
+    }
+
+    // NUMA placement: the arrays are reused on the NUMA domain they have been
+    // allocated on only, this has to be set up before the first partition
+    // is created
+    if (numa_placement)
+    {
+        if (mode != work_mode::dataflow)
+        {
+            std::cout << "NUMA placement is supported by the dataflow "
+                         "implementation only" << std::endl;
+            return hpx::finalize();
+        }
+        partition_data::pool_per_numa_domain();
+    }
+
+    if (migrate_on_access && mode != work_mode::dataflow)
+    {
+        std::cout << "Migrating partitions on access is supported by the "
+                     "dataflow implementation only" << std::endl;
+        return hpx::finalize();
+    }
+
+    if ((skip_quiescent || !vm["activity-threshold"].defaulted()) &&
+        mode != work_mode::dataflow)
+    {
+        std::cout << "Skipping quiescent partitions is supported by the "
+                     "dataflow implementation only" << std::endl;
+        return hpx::finalize();
+    }
+
+    std::size_t const nl = hpx::get_num_localities(hpx::launch::sync);
+
+    double weight = 1.0;    // Relative speed of this locality.
+    if (!locality_weight(vm["weights"].as<std::string>(), nl, weight))
+    {
+        std::cout << "Invalid locality weights: "
+                  << vm["weights"].as<std::string>() << std::endl;
+        return hpx::finalize();
+    }
+
+    // In-situ analysis
+    if (analysis_interval != 0 &&
+        !parse_analysis(vm["analysis"].as<std::string>(), analysis_kinds))
+    {
+        std::cout << "Invalid analysis: " << vm["analysis"].as<std::string>()
+                  << std::endl;
+        return hpx::finalize();
+    }
+    if (analysis_interval != 0 && mode != work_mode::dataflow)
+    {
+        std::cout << "In-situ analysis is supported by the dataflow "
+                     "implementation only" << std::endl;
+        return hpx::finalize();
+    }
+
+    // Parameters of the ensemble members, if more than one simulation is run
+    if (!parse_ensemble(vm["members"].as<std::size_t>(),
+            vm["member-k"].as<std::string>(),
+            vm["member-dt"].as<std::string>(),
+            vm["member-scale"].as<std::string>()))
+    {
+        std::cout << "Invalid ensemble specification" << std::endl;
+        return hpx::finalize();
+    }
+    if (!ensemble.empty() && mode != work_mode::dataflow)
+    {
+        std::cout << "Ensemble runs are supported by the dataflow "
+                     "implementation only" << std::endl;
+        return hpx::finalize();
+    }
+
+    // Localities joining or leaving an elastic run announce this to locality
+    // 0 before the steppers are created.
+    if (elastic_epoch != 0)
+    {
+        if (use_mailbox || analysis_interval != 0 || migrate_on_access ||
+            mode != work_mode::dataflow)
+        {
+            std::cout << "Elastic runs are supported by the dataflow "
+                         "implementation without --mailbox, in-situ "
+                         "analysis, and --migrate-on-access only"
+                      << std::endl;
+            return hpx::finalize();
+        }
+
+        std::vector<membership_change> changes;
+        if (!parse_membership_changes(
+                vm["join"].as<std::string>(), true, changes) ||
+            !parse_membership_changes(
+                vm["leave"].as<std::string>(), false, changes))
+        {
+            std::cout << "Invalid --join or --leave specification"
+                      << std::endl;
+            return hpx::finalize();
+        }
+
+        hpx::id_type const root = hpx::naming::get_id_from_locality_id(0);
+        for (membership_change const& c : changes)
+        {
+            if (c.locality == hpx::get_locality_id())
+                announce_membership_change_action()(root, c);
+        }
+    }
+
+    // Name of the trace file, tracing is disabled if empty
+    std::string trace_file = vm["trace"].as<std::string>();
+
+    if (vm.count("validate"))
+        validate = true;
+    if (vm.count("spectral-reference"))
+        spectral_reference = true;
+
+    // Service mode: locality 0 runs the jobs it reads on the steppers it
+    // creates on all localities, the other localities just host them
+    if (vm.count("service"))
+    {
+        // the analysis files of the jobs would overwrite each other, the
+        // traffic, trace, and statistics are collected by do_all_work only
+        if (use_mailbox || elastic_epoch != 0 || !ensemble.empty() ||
+            analysis_interval != 0 || vm.count("traffic") ||
+            !vm["traffic-file"].as<std::string>().empty() ||
+            !trace_file.empty() || memory_budget != 0 || report_statistics)
+        {
+            std::cout << "The service mode does not support --mailbox, "
+                         "elastic, ensemble runs, in-situ analysis, "
+                         "--traffic, --trace, --memory-budget, or "
+                         "--statistics"
+                      << std::endl;
+            return hpx::finalize();
+        }
+
+        // all spectral runs of a locality share one exchange buffer
+        if (mode == work_mode::spectral &&
+            vm["service-concurrency"].as<std::size_t>() > 1)
+        {
+            std::cout << "The spectral implementation runs one job at a "
+                         "time" << std::endl;
+            return hpx::finalize();
+        }
+
+        bool success = true;
+        if (0 == hpx::get_locality_id())
+        {
+            job defaults;
+            defaults.nx = nx;
+            defaults.np = np;
+            defaults.nt = nt;
+            defaults.nd = nd;
+            defaults.k = k;
+            defaults.dt = dt;
+            defaults.dx = dx;
+
+            success = run_service(vm["service"].as<std::string>(), defaults,
+                vm["weights"].as<std::string>(),
+                vm["service-concurrency"].as<std::size_t>(),
+                vm["tolerance"].as<double>());
+        }
+
+        hpx::finalize();
+        return success ? 0 : 1;
+    }
+
+    // Account the messages sent between the localities, the results are
+    // printed (or written to the given file) at the end of the run
+    std::string traffic_file = vm["traffic-file"].as<std::string>();
+    if (vm.count("traffic") || !traffic_file.empty())
+        account_traffic = true;
+
+    bool success = do_all_work(nt, nx, np, nd, weight, memory_budget,
+        trace_file, traffic_file, vm["tolerance"].as<double>());
+
+    hpx::finalize();
+    return success ? 0 : 1;
 }
 
 int main(int argc, char* argv[])
@@ -140,8 +546,153 @@ int main(int argc, char* argv[])
         ("dx", value<double>(&dx)->default_value(1.0),
          "Local x dimension")
         ( "no-header", "do not print out the csv header row")
+        ("mode", value<std::string>()->default_value("dataflow"),
+         "Implementation of the time step loop: dataflow, coroutine, replay, "
+         "tiled, spectral (default: dataflow)")
+        ("numa", "run contiguous ranges of the local partitions on executors "
+         "bound to the NUMA domains and keep their data in per domain pools "
+         "(dataflow mode, combine with --hpx:numa-sensitive to avoid "
+         "stealing across NUMA domains)")
+        ("service", value<std::string>(),
+         "Keep running and execute the jobs read from the given file or "
+         "pipe ('-' for the standard input), one job per line given as "
+         "key=value pairs of nx, np, nt, nd, k, dt, dx, and scale")
+        ("service-concurrency", value<std::size_t>()->default_value(1),
+         "Number of jobs of the service mode which may run at the same "
+         "time if they use the same k, dt, dx, and scale (default: 1)")
+        ("skip-quiescent", "forward partitions unchanged to the next time "
+         "step as long as neither they nor their neighbors changed by more "
+         "than --activity-threshold during their last update (dataflow "
+         "mode)")
+        ("activity-threshold", value<double>(&activity_threshold)
+            ->default_value(0.0),
+         "Largest change of a partition considered quiescent, 0 skips only "
+         "updates which would not change anything (default: 0)")
+        ("copy-halos", "send copies of the boundary elements instead of "
+         "references which keep the neighboring partitions alive")
+        ("memory-budget", value<std::uint64_t>()->default_value(0),
+         "Memory budget per locality in bytes, limits the depth of the "
+         "dependency tree instead of --nd (default: 0, no limit)")
+        ("ooc-dir", value<std::string>(&ooc_directory)->default_value(""),
+         "Keep the partitions in memory mapped files in the given directory "
+         "on local disk, which allows for grids larger than the memory "
+         "(dataflow mode, default: in memory)")
+        ("ooc-prefetch", value<std::size_t>(&ooc_prefetch)->default_value(2),
+         "Number of partitions read ahead of their update in the "
+         "out-of-core mode (default: 2)")
+        ("ooc-min-size", value<std::size_t>()->default_value(65536),
+         "Smallest partition (in bytes) kept in a memory mapped file in the "
+         "out-of-core mode, smaller ones are kept in memory "
+         "(default: 65536)")
+        ("migrate-on-access", "migrate the partitions to the locality "
+         "requesting most of their data once it did so for "
+         "--affinity-sustain consecutive windows (dataflow mode)")
+        ("affinity-window", value<std::size_t>(&affinity_window)
+            ->default_value(32),
+         "Number of data requests per observation window of a partition "
+         "(default: 32)")
+        ("affinity-share", value<double>(&affinity_share)
+            ->default_value(0.75),
+         "Share of the requests of a window a remote locality has to issue "
+         "to dominate it (default: 0.75)")
+        ("affinity-sustain", value<std::size_t>(&affinity_sustain)
+            ->default_value(2),
+         "Number of consecutive windows the same locality has to dominate "
+         "before the partition is migrated (default: 2)")
+        ("affinity-cooldown", value<std::size_t>(&affinity_cooldown)
+            ->default_value(8),
+         "Number of windows after a migration during which the partition "
+         "stays where it is (default: 8)")
+        ("statistics", "print statistics (peak resident memory, allocator "
+         "pool usage) for every locality")
+        ("no-boundary-priority", "run the updates of the partitions sent "
+         "to the neighbors and the sends with the same priority as the "
+         "interior partitions")
+        ("analyze-every", value<std::size_t>(&analysis_interval)
+            ->default_value(0),
+         "Analyze the local partitions every given number of time steps "
+         "while the computation proceeds (dataflow mode, default: 0, never)")
+        ("analysis", value<std::string>()->default_value("reductions"),
+         "Comma separated list of analyses: reductions (sum, energy, min, "
+         "max), histogram, snapshot (default: reductions)")
+        ("analysis-file", value<std::string>(&analysis_file)
+            ->default_value("analysis"),
+         "Prefix of the analysis output, every locality writes "
+         "<prefix>.<locality>.csv (default: analysis)")
+        ("analysis-queue", value<std::size_t>(&analysis_queue)
+            ->default_value(4),
+         "Number of time steps analyzed concurrently, further time steps are "
+         "skipped (default: 4)")
+        ("histogram-bins", value<std::size_t>(&histogram_bins)
+            ->default_value(16),
+         "Number of bins of the histogram analysis (default: 16)")
+        ("snapshot-stride", value<std::size_t>(&snapshot_stride)
+            ->default_value(1024),
+         "Distance between the grid points of the snapshot analysis "
+         "(default: 1024)")
+        ("mailbox", "receive the boundary elements through lock-free "
+         "fixed capacity mailboxes instead of receive buffers")
+        ("elastic-epoch", value<std::size_t>(&elastic_epoch)
+            ->default_value(0),
+         "Compute the time steps in epochs of the given number of steps, the "
+         "localities may join or leave between two epochs (dataflow mode, "
+         "default: 0, not elastic)")
+        ("join", value<std::string>()->default_value(""),
+         "Comma separated list of <locality>:<step>, the given localities "
+         "stay idle until the first epoch starting at or after the given "
+         "time step (elastic runs)")
+        ("leave", value<std::string>()->default_value(""),
+         "Comma separated list of <locality>:<step>, the partitions of the "
+         "given localities are migrated away at the first epoch starting at "
+         "or after the given time step (elastic runs)")
+        ("members", value<std::size_t>()->default_value(1),
+         "Number of independent simulations (ensemble members) advanced "
+         "together (dataflow mode, default: 1)")
+        ("member-k", value<std::string>()->default_value(""),
+         "Heat transfer coefficient of the ensemble members: one value, a "
+         "comma separated list of one value per member, or a range "
+         "first:last (default: --k)")
+        ("member-dt", value<std::string>()->default_value(""),
+         "Time step of the ensemble members, same format as --member-k "
+         "(default: --dt)")
+        ("member-scale", value<std::string>()->default_value(""),
+         "Factor applied to the initial conditions of the ensemble members, "
+         "same format as --member-k (default: 1)")
+        ("validate", "compare the final solution with a serial reference "
+         "implementation, fails if the error exceeds --tolerance")
+        ("spectral-reference", "validate against the spectral solution "
+         "computed by an FFT instead of the serial time stepping, which is "
+         "much faster for many time steps")
+        ("tolerance", value<double>()->default_value(1e-10),
+         "Largest acceptable error relative to the largest value of the "
+         "reference solution (default: 1e-10)")
+        ("trace", value<std::string>()->default_value(""),
+         "Record a timeline of the computation and write it as a Chrome "
+         "trace (JSON) to the given file (default: no tracing)")
+        ("trace-buffer", value<std::size_t>(&trace_buffer_size)
+            ->default_value(65536),
+         "Number of trace events kept per worker thread, older events are "
+         "overwritten")
+        ("traffic", "count the messages and bytes sent between the "
+         "localities per action and destination, print them at the end of "
+         "the run")
+        ("traffic-file", value<std::string>()->default_value(""),
+         "Write the counted messages as csv to the given file instead of "
+         "printing them (implies --traffic)")
+        ("weights", value<std::string>()->default_value("equal"),
+         "Distribution of the partitions over the localities: equal, "
+         "threads, calibrate, or a comma separated list of one weight per "
+         "locality (default: equal)")
+        ("tile-steps", value<std::size_t>(&tile_steps)->default_value(8),
+         "Number of time steps computed per pass over a tile (tiled mode)")
+        ("tile-size", value<std::size_t>(&tile_size)->default_value(4096),
+         "Number of grid points per tile (tiled mode)")
     ;
 
+    // Make the allocator statistics available as performance counters, e.g.
+    // --hpx:print-counter=/partition_allocator{locality#*/total}/count/hits
+    hpx::register_startup_function(&register_statistics_counters);
+
     // Initialize and run HPX, this example requires to run hpx_main on all
     // localities
     std::vector<std::string> const cfg = {
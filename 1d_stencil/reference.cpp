@@ -0,0 +1,99 @@
+#include "reference.hpp"
+#include "fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+std::vector<double> reference_solution(
+    std::vector<std::size_t> const& partitions, std::size_t nx,
+    std::size_t nt, double c, double scale)
+{
+    std::vector<double> u;
+    for (std::size_t local_np : partitions)
+    {
+        for (std::size_t i = 0; i != local_np * nx; ++i)
+        {
+            u.push_back(scale * double(i));
+        }
+    }
+
+    std::size_t const size = u.size();
+    if (size == 0)
+        return u;
+
+    // the same operator as stepper_server::heat, evaluated the same way to
+    // keep the rounding errors comparable
+    std::vector<double> w(size);
+    for (std::size_t t = 0; t != nt; ++t)
+    {
+        for (std::size_t i = 0; i != size; ++i)
+        {
+            double left = u[i == 0 ? size - 1 : i - 1];
+            double right = u[i == size - 1 ? 0 : i + 1];
+            w[i] = u[i] + c * (left - 2 * u[i] + right);
+        }
+        std::swap(u, w);
+    }
+    return u;
+}
+
+double amplification(std::size_t k, std::size_t n, double c)
+{
+    double const s = std::sin(3.14159265358979323846 * double(k) / double(n));
+    return 1.0 - 4.0 * c * s * s;
+}
+
+std::vector<double> spectral_solution(
+    std::vector<std::size_t> const& partitions, std::size_t nx,
+    std::size_t nt, double c, double scale)
+{
+    std::vector<std::complex<double>> u;
+    for (std::size_t local_np : partitions)
+    {
+        for (std::size_t i = 0; i != local_np * nx; ++i)
+        {
+            u.push_back(scale * double(i));
+        }
+    }
+
+    std::size_t const size = u.size();
+    fft(u.data(), size);
+    for (std::size_t k = 0; k != size; ++k)
+    {
+        u[k] *= std::pow(amplification(k, size, c), double(nt));
+    }
+    fft(u.data(), size, true);
+
+    std::vector<double> result(size);
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        result[i] = u[i].real() / double(size);
+    }
+    return result;
+}
+
+double max_error(
+    std::vector<double> const& reference, std::vector<double> const& solution)
+{
+    if (reference.size() != solution.size())
+        return std::numeric_limits<double>::infinity();
+
+    double scale = 1.0;
+    double error = 0.0;
+    for (std::size_t i = 0; i != reference.size(); ++i)
+    {
+        scale = (std::max)(scale, std::abs(reference[i]));
+
+        double diff = std::abs(reference[i] - solution[i]);
+        if (std::isnan(diff))
+            return std::numeric_limits<double>::infinity();
+        error = (std::max)(error, diff);
+    }
+    return error / scale;
+}
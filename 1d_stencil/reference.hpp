@@ -0,0 +1,41 @@
+#if !defined(REFERENCE_HPP_)
+#define REFERENCE_HPP_
+
+#include <cstddef>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Serial reference implementation of the periodic heat operator used to
+// validate the distributed solution (see --validate).
+//
+// The grid is the concatenation of the partitions of all localities, where
+// locality 'l' holds 'partitions[l]' partitions of 'nx' points each. The
+// initial conditions are the same as the ones used by the stepper: the
+// point 'j' of the local partition 'i' starts at 'i * nx + j' on every
+// locality, multiplied by 'scale'. The operator uses the coefficient
+// c = k * dt / (dx * dx). Returns the state of all grid points after 'nt'
+// time steps.
+std::vector<double> reference_solution(
+    std::vector<std::size_t> const& partitions, std::size_t nx,
+    std::size_t nt, double c, double scale = 1.0);
+
+// Amplification factor of the Fourier mode 'k' of a periodic grid of 'n'
+// points for one time step of the explicit scheme with the coefficient 'c':
+// the operator maps exp(2 pi i j k / n) to itself multiplied by
+// 1 - 4 c sin^2(pi k / n).
+double amplification(std::size_t k, std::size_t n, double c);
+
+// Spectral solution of the same problem as reference_solution, computed by
+// multiplying every Fourier mode of the initial conditions by its
+// amplification factor raised to the power 'nt'. This takes O(N log N)
+// operations independently of 'nt' (see --spectral-reference).
+std::vector<double> spectral_solution(
+    std::vector<std::size_t> const& partitions, std::size_t nx,
+    std::size_t nt, double c, double scale = 1.0);
+
+// Return the largest difference between the two solutions relative to the
+// largest magnitude of the reference solution (absolute if that is below 1).
+double max_error(
+    std::vector<double> const& reference, std::vector<double> const& solution);
+
+#endif    // REFERENCE_HPP_
@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+#
+# Strong and weak scaling study for the distributed heat solver.
+#
+# Runs 1d_stencil for all combinations of the given numbers of localities
+# (launched as local processes through hpxrun.py), worker threads, grid
+# points per partition (nx), partitions (np) and dependency tree depths (nd).
+# Every run validates its solution against the serial reference solver, the
+# study fails if any of the runs does not pass the validation.
+#
+# The output is the csv output of 1d_stencil with two additional columns:
+# the number of processing units (localities * threads) and the parallel
+# efficiency relative to the run with the fewest processing units of the
+# same (nx, np, nd) configuration:
+#
+#   strong scaling:  E = (T_0 * P_0) / (T * P)     (np fixed)
+#   weak scaling:    E = T_0 / T                   (np scaled with P / P_0)
+
+from __future__ import print_function
+
+import argparse
+import csv
+import itertools
+import subprocess
+import sys
+
+
+def int_list(value):
+    return [int(v) for v in value.split(',')]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Strong/weak scaling study for 1d_stencil')
+    parser.add_argument('--exe', required=True,
+        help='path of the 1d_stencil executable')
+    parser.add_argument('--hpxrun', default='hpxrun.py',
+        help='path of hpxrun.py used to launch the localities')
+    parser.add_argument('--scaling', choices=['strong', 'weak'],
+        default='strong', help='kind of scaling study (default: strong)')
+    parser.add_argument('--localities', type=int_list, default=[1, 2],
+        help='comma separated numbers of localities (default: 1,2)')
+    parser.add_argument('--threads', type=int_list, default=[1, 2, 4],
+        help='comma separated numbers of threads per locality '
+             '(default: 1,2,4)')
+    parser.add_argument('--nx', type=int_list, default=[10000],
+        help='comma separated numbers of points per partition')
+    parser.add_argument('--np', type=int_list, default=[32],
+        help='comma separated numbers of partitions (per processing unit '
+             'of the smallest run for weak scaling)')
+    parser.add_argument('--nd', type=int_list, default=[10],
+        help='comma separated depths of the dependency tree')
+    parser.add_argument('--nt', type=int, default=45,
+        help='number of time steps (default: 45)')
+    parser.add_argument('--tolerance', type=float, default=1e-10,
+        help='validation tolerance passed to 1d_stencil')
+    parser.add_argument('--parcelport', default='tcp',
+        help='parcelport used between the localities (default: tcp)')
+    parser.add_argument('extra', nargs='*',
+        help='additional arguments passed to 1d_stencil (after --)')
+    return parser.parse_args()
+
+
+def run(args, localities, threads, nx, np, nd):
+    cmd = [sys.executable, args.hpxrun, '-l', str(localities),
+        '-t', str(threads), '-p', args.parcelport, args.exe, '--',
+        '--nx=%d' % nx, '--np=%d' % np, '--nd=%d' % nd, '--nt=%d' % args.nt,
+        '--validate', '--tolerance=%g' % args.tolerance, '--no-header']
+    cmd += args.extra
+
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE, universal_newlines=True)
+    out, err = proc.communicate()
+    if proc.returncode != 0:
+        sys.stderr.write(err)
+        return None
+
+    # the first line of the output holds the timing results
+    for row in csv.reader(out.splitlines()):
+        if row:
+            return [field.strip() for field in row]
+    return None
+
+
+def main():
+    args = parse_args()
+
+    resources = sorted(itertools.product(args.localities, args.threads),
+        key=lambda r: (r[0] * r[1], r[0]))
+    base_pus = resources[0][0] * resources[0][1]
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(['Localities', 'OS_Threads', 'Execution_Time_sec',
+        'Points_per_Partition', 'Partitions', 'Time_Steps',
+        'Startup_Time_sec', 'Teardown_Time_sec', 'Points_per_sec',
+        'Max_Error', 'Members', 'Processing_Units', 'Parallel_Efficiency'])
+
+    failed = False
+    for nx, np, nd in itertools.product(args.nx, args.np, args.nd):
+        baseline = None
+        for localities, threads in resources:
+            pus = localities * threads
+            partitions = np
+            if args.scaling == 'weak':
+                partitions = np * pus // base_pus
+
+            result = run(args, localities, threads, nx, partitions, nd)
+            if result is None:
+                print('run failed or did not validate: localities=%d '
+                      'threads=%d nx=%d np=%d nd=%d' %
+                      (localities, threads, nx, partitions, nd),
+                      file=sys.stderr)
+                failed = True
+                continue
+
+            elapsed = float(result[2])
+            if baseline is None:
+                baseline = (elapsed, pus)
+
+            if args.scaling == 'strong':
+                efficiency = baseline[0] * baseline[1] / (elapsed * pus)
+            else:
+                efficiency = baseline[0] / elapsed
+
+            writer.writerow(result + [pus, '%.4f' % efficiency])
+            sys.stdout.flush()
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,405 @@
+#include "service.hpp"
+#include "decomposition.hpp"
+#include "options.hpp"
+#include "partition.hpp"
+#include "partition_data.hpp"
+#include "partition_server.hpp"
+#include "reference.hpp"
+#include "stepper_server.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/hpx.hpp>
+#include <hpx/include/run_as.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+bool parse_job(std::string const& line, job& j)
+{
+    std::istringstream is(line);
+    std::string item;
+    while (is >> item)
+    {
+        std::string::size_type eq = item.find('=');
+        if (eq == std::string::npos)
+            return false;
+
+        std::string const key = item.substr(0, eq);
+        std::string const value = item.substr(eq + 1);
+        try
+        {
+            if (key == "nx")
+                j.nx = std::stoull(value);
+            else if (key == "np")
+                j.np = std::stoull(value);
+            else if (key == "nt")
+                j.nt = std::stoull(value);
+            else if (key == "nd")
+                j.nd = std::stoull(value);
+            else if (key == "k")
+                j.k = std::stod(value);
+            else if (key == "dt")
+                j.dt = std::stod(value);
+            else if (key == "dx")
+                j.dx = std::stod(value);
+            else if (key == "scale")
+                j.scale = std::stod(value);
+            else
+                return false;
+        }
+        catch (std::exception const&)
+        {
+            return false;
+        }
+    }
+    return j.nd != 0;
+}
+
+// A scaled initial condition is run as an ensemble of one member
+void set_job_parameters(double new_k, double new_dt, double new_dx,
+    double scale)
+{
+    k = new_k;
+    dt = new_dt;
+    dx = new_dx;
+
+    ensemble.clear();
+    ensemble_coefficients.clear();
+    if (scale != 1.0)
+    {
+        ensemble.push_back(ensemble_member{k, dt, scale});
+        ensemble_coefficients.push_back(k * dt / (dx * dx));
+    }
+}
+
+HPX_REGISTER_ACTION(set_job_parameters_action);
+
+double get_locality_weight(std::string spec, std::size_t num_localities)
+{
+    double weight = 1.0;
+    if (!locality_weight(spec, num_localities, weight))
+    {
+        HPX_THROW_EXCEPTION(hpx::bad_parameter, "get_locality_weight",
+            "invalid locality weights: " + spec);
+    }
+    return weight;
+}
+
+HPX_REGISTER_ACTION(get_locality_weight_action);
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    hpx::lcos::local::mutex output_mtx;
+
+    bool same_parameters(job const& lhs, job const& rhs)
+    {
+        return lhs.k == rhs.k && lhs.dt == rhs.dt && lhs.dx == rhs.dx &&
+            lhs.scale == rhs.scale;
+    }
+
+    // Create one stepper on every locality and wire them up with their
+    // neighbors
+    std::vector<hpx::id_type> create_steppers(
+        std::vector<hpx::id_type> const& localities,
+        std::vector<std::size_t> const& partitions)
+    {
+        std::size_t const nl = localities.size();
+
+        std::vector<hpx::future<hpx::id_type>> created;
+        created.reserve(nl);
+        for (hpx::id_type const& locality : localities)
+        {
+            created.push_back(hpx::new_<stepper_server>(locality));
+        }
+
+        std::vector<hpx::id_type> steppers;
+        steppers.reserve(nl);
+        for (hpx::future<hpx::id_type>& f : created)
+        {
+            steppers.push_back(f.get());
+        }
+
+        std::vector<hpx::future<void>> wired;
+        wired.reserve(nl);
+        for (std::size_t i = 0; i != nl; ++i)
+        {
+            wired.push_back(hpx::async(set_topology_action(), steppers[i],
+                steppers[stepper_server::idx(i, -1, nl)],
+                steppers[stepper_server::idx(i, +1, nl)], partitions));
+        }
+        hpx::wait_all(wired);
+
+        return steppers;
+    }
+
+    // Run one job on the given set of steppers and print its results
+    bool run_job(std::vector<hpx::id_type> const& steppers,
+        std::vector<double> const& weights, job const& j, double tolerance)
+    {
+        std::size_t const nl = steppers.size();
+        if (j.np < nl)
+        {
+            hpx::util::format_to(std::cerr,
+                "Job {}: the number of partitions should not be smaller "
+                "than the number of localities\n",
+                j.id);
+            return false;
+        }
+
+        // only the dataflow and spectral implementations start from the
+        // scaled initial conditions (see set_job_parameters)
+        if (j.scale != 1.0 && mode != work_mode::dataflow &&
+            mode != work_mode::spectral)
+        {
+            hpx::util::format_to(std::cerr,
+                "Job {}: scaled initial conditions are supported by the "
+                "dataflow and spectral implementations only\n",
+                j.id);
+            return false;
+        }
+
+        std::vector<std::size_t> partitions = decompose(j.np, weights);
+
+        std::uint64_t t = hpx::util::high_resolution_clock::now();
+
+        std::vector<hpx::future<stepper_server::space>> work;
+        work.reserve(nl);
+        for (std::size_t l = 0; l != nl; ++l)
+        {
+            work.push_back(hpx::async(do_work_action(), steppers[l],
+                partitions[l], j.nx, j.nt, j.nd));
+        }
+
+        std::vector<hpx::future<partition_data>> solution;
+        solution.reserve(j.np);
+        for (hpx::future<stepper_server::space>& f : work)
+        {
+            for (partition const& p : f.get())
+            {
+                solution.push_back(
+                    p.get_data(partition_server::middle_partition));
+            }
+        }
+
+        std::vector<partition_data> data;
+        data.reserve(j.np);
+        for (hpx::future<partition_data>& f : solution)
+        {
+            data.push_back(f.get());
+        }
+
+        std::uint64_t const elapsed =
+            hpx::util::high_resolution_clock::now() - t;
+
+        // Compare the solution with the serial reference implementation
+        double error = -1.0;
+        if (validate)
+        {
+            std::vector<double> u;
+            u.reserve(j.np * j.nx);
+            for (partition_data const& d : data)
+            {
+                for (std::size_t i = 0; i != d.size(); ++i)
+                {
+                    u.push_back(d(i, 0));
+                }
+            }
+
+            double const c = j.k * j.dt / (j.dx * j.dx);
+            std::vector<double> const reference = spectral_reference ?
+                spectral_solution(partitions, j.nx, j.nt, c, j.scale) :
+                reference_solution(partitions, j.nx, j.nt, c, j.scale);
+            error = max_error(reference, u);
+        }
+
+        double const points_per_sec = elapsed != 0 ?
+            double(j.nx) * j.np * j.nt / (elapsed / 1e9) :
+            0.;
+        std::string const error_str =
+            error >= 0 ? hpx::util::format("{:.6g}", error) : "";
+
+        {
+            std::lock_guard<hpx::lcos::local::mutex> l(output_mtx);
+            hpx::util::format_to(std::cout,
+                "{},{},{:.14g},{},{},{},{},{:.14g},{:.14g},{:.14g},{}\n", j.id,
+                nl, elapsed / 1e9, j.nx, j.np, j.nt, j.nd, j.k, j.dt,
+                points_per_sec, error_str)
+                << std::flush;
+        }
+
+        if (error > tolerance)
+        {
+            hpx::util::format_to(std::cerr,
+                "Job {}: validation failed, the maximum relative error {} "
+                "exceeds the tolerance {}\n",
+                j.id, error, tolerance);
+            return false;
+        }
+        return true;
+    }
+
+    // Wait for all running jobs to finish
+    bool wait_for_jobs(std::vector<hpx::future<bool>>& running)
+    {
+        bool success = true;
+        for (hpx::future<bool>& f : running)
+        {
+            if (f.valid())
+                success = f.get() && success;
+        }
+        return success;
+    }
+
+    // Reading from a pipe blocks until the next job arrives, which must not
+    // block the worker thread.
+    bool read_line(std::istream& in, std::string& line)
+    {
+        return hpx::threads::run_as_os_thread(
+            [&in, &line]() -> bool { return bool(std::getline(in, line)); })
+            .get();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool run_service(std::string const& source, job const& defaults,
+    std::string const& weights_spec, std::size_t concurrency,
+    double tolerance)
+{
+    std::ifstream file;
+    if (source != "-")
+    {
+        file.open(source);
+        if (!file)
+        {
+            std::cerr << "Unable to read jobs from: " << source << std::endl;
+            return false;
+        }
+    }
+    std::istream& in = source != "-" ? file : std::cin;
+
+    std::vector<hpx::id_type> localities = hpx::find_all_localities();
+    std::size_t const nl = localities.size();
+
+    // the weights are determined by every locality itself
+    std::vector<hpx::future<double>> weighted;
+    for (hpx::id_type const& locality : localities)
+    {
+        weighted.push_back(hpx::async(
+            get_locality_weight_action(), locality, weights_spec, nl));
+    }
+
+    std::vector<double> weights;
+    for (hpx::future<double>& f : weighted)
+    {
+        weights.push_back(f.get());
+    }
+
+    // one set of steppers for every job which may run concurrently
+    concurrency = (std::max)(concurrency, std::size_t(1));
+
+    std::vector<std::size_t> const partitions =
+        decompose((std::max)(std::size_t(defaults.np), nl), weights);
+
+    std::vector<std::vector<hpx::id_type>> slots;
+    slots.reserve(concurrency);
+    for (std::size_t s = 0; s != concurrency; ++s)
+    {
+        slots.push_back(create_steppers(localities, partitions));
+    }
+
+    if (header)
+    {
+        std::cout << "Job,Localities,Execution_Time_sec,"
+                     "Points_per_Partition,Partitions,Time_Steps,"
+                     "Dependency_Depth,k,dt,Points_per_sec,Max_Error\n"
+                  << std::flush;
+    }
+
+    bool success = true;
+
+    std::vector<hpx::future<bool>> running(concurrency);
+    job current;
+    bool have_parameters = false;
+    std::size_t num_jobs = 0;
+
+    std::string line;
+    while (read_line(in, line))
+    {
+        std::string::size_type first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::string::size_type last = line.find_last_not_of(" \t\r");
+        line = line.substr(first, last - first + 1);
+        if (line == "quit")
+            break;
+
+        job j = defaults;
+        if (!parse_job(line, j))
+        {
+            std::cerr << "Invalid job specification: " << line << std::endl;
+            success = false;
+            continue;
+        }
+        j.id = ++num_jobs;
+
+        // the parameters of the heat operator are changed once all running
+        // jobs have finished
+        if (!have_parameters || !same_parameters(j, current))
+        {
+            success = wait_for_jobs(running) && success;
+
+            std::vector<hpx::future<void>> updated;
+            for (hpx::id_type const& locality : localities)
+            {
+                updated.push_back(hpx::async(set_job_parameters_action(),
+                    locality, j.k, j.dt, j.dx, j.scale));
+            }
+            hpx::wait_all(updated);
+
+            current = j;
+            have_parameters = true;
+        }
+
+        // wait for a set of steppers to become available
+        auto free = std::find_if(running.begin(), running.end(),
+            [](hpx::future<bool> const& f) { return !f.valid(); });
+        if (free == running.end())
+        {
+            auto any = hpx::when_any(running).get();
+            running = std::move(any.futures);
+            free = running.begin() + any.index;
+            success = free->get() && success;
+        }
+
+        std::size_t const slot = free - running.begin();
+        *free = hpx::async(&run_job, std::cref(slots[slot]), std::cref(weights),
+            j, tolerance);
+    }
+
+    success = wait_for_jobs(running) && success;
+
+    // break the cyclic dependencies of the steppers
+    std::vector<hpx::future<void>> released;
+    for (std::vector<hpx::id_type> const& steppers : slots)
+    {
+        for (hpx::id_type const& id : steppers)
+        {
+            released.push_back(
+                hpx::async(release_dependencies_action(), id));
+        }
+    }
+    hpx::wait_all(released);
+
+    return success;
+}
@@ -0,0 +1,62 @@
+#if !defined(SERVICE_HPP_)
+#define SERVICE_HPP_
+
+#include <hpx/include/actions.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////
+// Service mode (see --service)
+//
+// Locality 0 reads a stream of job specifications from a file or a pipe and
+// runs them one after the other on the same runtime, reusing the steppers
+// and the pooled partition arrays of all localities. Every line specifies
+// one job as a whitespace separated list of key=value pairs, the keys are
+// nx, np, nt, nd, k, dt, dx, and scale (the factor applied to the initial
+// conditions f(0, i) = i). Keys which are not given default to the values
+// given on the command line. Empty lines and lines starting with '#' are
+// ignored, the service ends at the end of the stream or at a line 'quit'.
+//
+// Up to 'concurrency' jobs run at the same time, each on its own set of
+// steppers. As the parameters of the heat operator are shared by all jobs
+// of a locality, a job only starts while all running jobs use the same k,
+// dt, dx, and scale, otherwise it waits for them to finish first.
+struct job
+{
+    std::size_t id = 0;
+    std::uint64_t nx = 0;
+    std::uint64_t np = 0;
+    std::uint64_t nt = 0;
+    std::uint64_t nd = 0;
+    double k = 0.;
+    double dt = 0.;
+    double dx = 0.;
+    double scale = 1.;
+};
+
+// Update 'j' with the values given by 'line', returns false if the line is
+// invalid.
+bool parse_job(std::string const& line, job& j);
+
+// Set the parameters of the heat operator on this locality
+void set_job_parameters(double k, double dt, double dx, double scale);
+
+HPX_DEFINE_PLAIN_ACTION(set_job_parameters, set_job_parameters_action);
+HPX_REGISTER_ACTION_DECLARATION(set_job_parameters_action);
+
+// Return the weight of this locality according to the --weights
+// specification
+double get_locality_weight(std::string spec, std::size_t num_localities);
+
+HPX_DEFINE_PLAIN_ACTION(get_locality_weight, get_locality_weight_action);
+HPX_REGISTER_ACTION_DECLARATION(get_locality_weight_action);
+
+// Run all jobs read from 'source' ('-' is the standard input) on locality
+// 0, 'defaults' holds the values given on the command line. Returns false
+// if any of the jobs failed or did not pass the validation.
+bool run_service(std::string const& source, job const& defaults,
+    std::string const& weights, std::size_t concurrency, double tolerance);
+
+#endif    // SERVICE_HPP_
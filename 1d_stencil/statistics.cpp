@@ -0,0 +1,224 @@
+#include "statistics.hpp"
+#include "affinity.hpp"
+#include "halo_mailbox.hpp"
+#include "partition_data.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/hpx.hpp>
+#include <hpx/include/performance_counters.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#if defined(HPX_WINDOWS)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Return the peak resident set size of this process
+static std::uint64_t peak_resident_memory()
+{
+#if defined(HPX_WINDOWS)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(
+            GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return std::uint64_t(usage.ru_maxrss);    // [bytes]
+#else
+    return std::uint64_t(usage.ru_maxrss) * 1024;    // [kB]
+#endif
+#endif
+}
+
+std::atomic<std::uint64_t>& skipped_updates()
+{
+    static std::atomic<std::uint64_t> skipped(0);
+    return skipped;
+}
+
+locality_statistics collect_statistics()
+{
+    locality_statistics s;
+    s.locality = hpx::get_locality_id();
+    s.peak_resident_memory = peak_resident_memory();
+    s.allocator = partition_data::allocator_statistics();
+
+    halo_mailbox_counters const& mailbox = halo_mailbox_statistics();
+    s.mailbox_stores = mailbox.stores;
+    s.mailbox_receives = mailbox.receives;
+    s.mailbox_waits = mailbox.waits;
+    s.skipped_updates = skipped_updates();
+    s.auto_migrations = affinity_migrations();
+    s.failed_auto_migrations = affinity_failed_migrations();
+    return s;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The counters report the values accumulated since the start of the run (or
+// since the last reset). Resetting a counter does not affect the other
+// counters, the gauges of the allocator pool are never reset.
+namespace {
+    template <std::uint64_t partition_allocator_statistics::*Field>
+    std::int64_t allocator_counter(bool reset)
+    {
+        return std::int64_t(
+            partition_data::allocator_statistic(Field, reset));
+    }
+
+    struct counter_info
+    {
+        char const* name;
+        std::int64_t (*value)(bool);
+        char const* helptext;
+        char const* uom;
+    };
+
+    using stats = partition_allocator_statistics;
+
+    counter_info const allocator_counters[] = {
+        {"/partition_allocator/count/allocations",
+            &allocator_counter<&stats::allocations>,
+            "returns the number of partition arrays allocated", ""},
+        {"/partition_allocator/count/hits", &allocator_counter<&stats::hits>,
+            "returns the number of allocations served from the pool", ""},
+        {"/partition_allocator/count/misses",
+            &allocator_counter<&stats::misses>,
+            "returns the number of allocations not served from the pool", ""},
+        {"/partition_allocator/count/frees", &allocator_counter<&stats::frees>,
+            "returns the number of arrays released since the pool was full",
+            ""},
+        {"/partition_allocator/count/pooled",
+            &allocator_counter<&stats::pooled_arrays>,
+            "returns the number of arrays currently kept in the pool", ""},
+        {"/partition_allocator/size/pooled",
+            &allocator_counter<&stats::pooled_bytes>,
+            "returns the number of bytes currently kept in the pool", "bytes"},
+        {"/partition_allocator/size/in_use",
+            &allocator_counter<&stats::bytes_in_use>,
+            "returns the number of bytes currently handed out", "bytes"},
+        {"/partition_allocator/size/high_water_mark",
+            &allocator_counter<&stats::high_water_mark>,
+            "returns the largest number of bytes held by the allocator",
+            "bytes"},
+        {"/partition_allocator/count/contentions",
+            &allocator_counter<&stats::contentions>,
+            "returns the number of contended lock acquisitions", ""},
+        {"/partition_allocator/time/contention",
+            &allocator_counter<&stats::contention_time>,
+            "returns the time spent waiting for the allocator lock", "ns"},
+    };
+
+    template <std::atomic<std::uint64_t> halo_mailbox_counters::*Field>
+    std::int64_t mailbox_counter(bool reset)
+    {
+        std::atomic<std::uint64_t>& value = halo_mailbox_statistics().*Field;
+        return std::int64_t(reset ? value.exchange(0) : value.load());
+    }
+
+    counter_info const mailbox_counters[] = {
+        {"/halo_mailbox/count/stores",
+            &mailbox_counter<&halo_mailbox_counters::stores>,
+            "returns the number of boundary elements stored in the mailboxes",
+            ""},
+        {"/halo_mailbox/count/receives",
+            &mailbox_counter<&halo_mailbox_counters::receives>,
+            "returns the number of boundary elements requested from the "
+            "mailboxes",
+            ""},
+        {"/halo_mailbox/count/waits",
+            &mailbox_counter<&halo_mailbox_counters::waits>,
+            "returns the number of times a mailbox slot was still in use",
+            ""},
+    };
+
+    std::int64_t skipped_updates_counter(bool reset)
+    {
+        std::atomic<std::uint64_t>& value = skipped_updates();
+        return std::int64_t(reset ? value.exchange(0) : value.load());
+    }
+
+    std::int64_t auto_migrations_counter(bool reset)
+    {
+        std::atomic<std::uint64_t>& value = affinity_migrations();
+        return std::int64_t(reset ? value.exchange(0) : value.load());
+    }
+
+    std::int64_t failed_auto_migrations_counter(bool reset)
+    {
+        std::atomic<std::uint64_t>& value = affinity_failed_migrations();
+        return std::int64_t(reset ? value.exchange(0) : value.load());
+    }
+}
+
+void register_statistics_counters()
+{
+    for (counter_info const& info : allocator_counters)
+    {
+        hpx::performance_counters::install_counter_type(
+            info.name, info.value, info.helptext, info.uom);
+    }
+    for (counter_info const& info : mailbox_counters)
+    {
+        hpx::performance_counters::install_counter_type(
+            info.name, info.value, info.helptext, info.uom);
+    }
+    hpx::performance_counters::install_counter_type(
+        "/stepper/count/skipped_updates", &skipped_updates_counter,
+        "returns the number of partition updates skipped as the partitions "
+        "were quiescent",
+        "");
+    hpx::performance_counters::install_counter_type(
+        "/partition/count/auto_migrations", &auto_migrations_counter,
+        "returns the number of partitions migrated to the locality "
+        "dominating their accesses",
+        "");
+    hpx::performance_counters::install_counter_type(
+        "/partition/count/failed_auto_migrations",
+        &failed_auto_migrations_counter,
+        "returns the number of partitions which could not be migrated to "
+        "the locality dominating their accesses",
+        "");
+}
+
+void print_statistics(
+    std::vector<locality_statistics> const& statistics, bool header)
+{
+    if (header)
+        std::cout << "Locality,Peak_Resident_Memory_MB,Allocations,Pool_Hits,"
+                     "Pool_Misses,Pool_Frees,Pooled_Arrays,Pooled_MB,"
+                     "In_Use_MB,High_Water_Mark_MB,Lock_Contentions,"
+                     "Lock_Contention_Time_sec,Mailbox_Stores,"
+                     "Mailbox_Receives,Mailbox_Waits,Skipped_Updates,"
+                     "Auto_Migrations,Failed_Auto_Migrations\n"
+                  << std::flush;
+
+    double const mb = 1024. * 1024.;
+    for (locality_statistics const& s : statistics)
+    {
+        partition_allocator_statistics const& a = s.allocator;
+        hpx::util::format_to(std::cout,
+            "{},{:.6g},{},{},{},{},{},{:.6g},{:.6g},{:.6g},{},{:.14g},{},{},"
+            "{},{},{},{}\n",
+            s.locality, s.peak_resident_memory / mb, a.allocations, a.hits,
+            a.misses, a.frees, a.pooled_arrays, a.pooled_bytes / mb,
+            a.bytes_in_use / mb, a.high_water_mark / mb, a.contentions,
+            a.contention_time / 1e9, s.mailbox_stores, s.mailbox_receives,
+            s.mailbox_waits, s.skipped_updates, s.auto_migrations,
+            s.failed_auto_migrations)
+            << std::flush;
+    }
+}
+
+HPX_REGISTER_GATHER(locality_statistics, locality_statistics_gatherer);
@@ -0,0 +1,55 @@
+#if !defined(STATISTICS_HPP_)
+#define STATISTICS_HPP_
+
+#include "partition_allocator.hpp"
+
+#include <hpx/include/serialization.hpp>
+#include <hpx/lcos/gather.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Statistics collected on every locality at the end of a run
+struct locality_statistics
+{
+    std::uint32_t locality;
+    std::uint64_t peak_resident_memory;    // [bytes]
+    partition_allocator_statistics allocator;
+    std::uint64_t mailbox_stores;      // see halo_mailbox_counters
+    std::uint64_t mailbox_receives;
+    std::uint64_t mailbox_waits;
+    std::uint64_t skipped_updates;     // see --skip-quiescent
+    std::uint64_t auto_migrations;     // see --migrate-on-access
+    std::uint64_t failed_auto_migrations;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        ar & locality & peak_resident_memory & allocator & mailbox_stores &
+            mailbox_receives & mailbox_waits & skipped_updates &
+            auto_migrations & failed_auto_migrations;
+    }
+};
+
+// Number of partition updates skipped on this locality as the partitions
+// were quiescent
+std::atomic<std::uint64_t>& skipped_updates();
+
+// Install the performance counters exposing the allocator, mailbox,
+// skipping, and migration statistics, this has to be registered as a
+// startup function on every locality
+void register_statistics_counters();
+
+// Collect the statistics of this locality
+locality_statistics collect_statistics();
+
+// Print the statistics gathered from all localities
+void print_statistics(
+    std::vector<locality_statistics> const& statistics, bool header);
+
+HPX_REGISTER_GATHER_DECLARATION(
+    locality_statistics, locality_statistics_gatherer);
+
+#endif    // STATISTICS_HPP_
@@ -1,10 +1,15 @@
 #if !defined(STEPPER_HPP_)
 #define STEPPER_HPP_
 
+#include "decomposition.hpp"
 #include "stepper_server.hpp"
 
 #include <hpx/include/components.hpp>
 #include <hpx/include/future.hpp>
+#include <hpx/lcos/gather.hpp>
+
+#include <cstddef>
+#include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 // This is a client side member function can now be implemented as the
@@ -14,11 +19,52 @@ struct stepper : hpx::components::client_base<stepper, stepper_server>
     using base_type = hpx::components::client_base<stepper, stepper_server>;
 
     // construct new instances/wrap existing steppers from other localities
-    stepper(std::size_t num_localities)
-      : base_type(hpx::new_<stepper_server>(hpx::find_here(), num_localities))
+    //
+    // The steppers of all localities are wired up with their neighbors in
+    // one collective step: locality 0 gathers the ids and weights of all
+    // steppers, distributes the 'np' partitions according to the weights, and
+    // sends every stepper the ids of its left and right neighbors together
+    // with the resulting decomposition. This returns on locality 0 once all
+    // steppers know their neighbors.
+    stepper(std::size_t num_localities, std::size_t np, double weight)
+      : base_type(hpx::new_<stepper_server>(hpx::find_here()))
     {
-        hpx::register_with_basename(
-            stepper_basename, get_id(), hpx::get_locality_id());
+        stepper_info info{get_id(), weight};
+
+        if (0 == hpx::get_locality_id())
+        {
+            steppers_ = hpx::lcos::gather_here(bootstrap_basename,
+                hpx::make_ready_future(info), num_localities)
+                .get();
+            std::vector<stepper_info> const& steppers = steppers_;
+
+            std::vector<double> weights;
+            weights.reserve(num_localities);
+            for (stepper_info const& s : steppers)
+            {
+                weights.push_back(s.weight);
+            }
+
+            std::vector<std::size_t> partitions = decompose(np, weights);
+
+            std::vector<hpx::future<void>> wired;
+            wired.reserve(num_localities);
+            for (std::size_t i = 0; i != num_localities; ++i)
+            {
+                wired.push_back(hpx::async(set_topology_action(),
+                    steppers[i].id,
+                    steppers[stepper_server::idx(i, -1, num_localities)].id,
+                    steppers[stepper_server::idx(i, +1, num_localities)].id,
+                    partitions));
+            }
+            hpx::wait_all(wired);
+        }
+        else
+        {
+            hpx::lcos::gather_there(
+                bootstrap_basename, hpx::make_ready_future(info))
+                .wait();
+        }
     }
 
     stepper(hpx::future<hpx::id_type>&& id)
@@ -29,14 +75,23 @@ struct stepper : hpx::components::client_base<stepper, stepper_server>
     ~stepper()
     {
         // break cyclic dependencies
-        hpx::future<void> f1 =
+        hpx::future<void> f =
             hpx::async(release_dependencies_action(), get_id());
 
-        // release the reference held by AGAS
-        hpx::future<void> f2 = hpx::unregister_with_basename(
-            stepper_basename, hpx::get_locality_id());
+        hpx::wait_all(f);    // ignore exceptions
+    }
 
-        hpx::wait_all(f1, f2);    // ignore exceptions
+    // return the number of partitions assigned to each of the localities
+    std::vector<std::size_t> partitions() const
+    {
+        return get_partitions_action()(get_id());
+    }
+
+    // return the ids and weights of the steppers of all localities, this
+    // is available on locality 0 only
+    std::vector<stepper_info> const& steppers() const
+    {
+        return steppers_;
     }
 
     hpx::future<stepper_server::space> do_work(
@@ -44,6 +99,9 @@ struct stepper : hpx::components::client_base<stepper, stepper_server>
     {
         return hpx::async(do_work_action(), get_id(), local_np, nx, nt, nd);
     }
+
+private:
+    std::vector<stepper_info> steppers_;
 };
 
 #endif    // STEPPER_HPP_
@@ -1,16 +1,58 @@
 #include "stepper_server.hpp"
+#include "statistics.hpp"
+#include "traffic.hpp"
 
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
 #include <hpx/include/naming.hpp>
+#include <hpx/format.hpp>
+#include <hpx/include/util.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// The boundary elements are on the critical path of the neighbors, with
+// boundary_priority set they are handled with high priority on the
+// receiving end.
 void stepper_server::send_left(std::size_t t, partition p) const
 {
-    hpx::apply(from_right_action(), left_.get(), t, std::move(p));
+    trace_scope trace(trace_kind::send_left, 0, t);
+    if (account_traffic)
+    {
+        record_traffic(traffic_kind::from_right,
+            hpx::naming::get_locality_id_from_id(left_.get()),
+            serialized_size(t) + id_size());
+    }
+    hpx::apply_p(from_right_action(), left_.get(), send_priority(), t,
+        std::move(p));
 }
 void stepper_server::send_right(std::size_t t, partition p) const
 {
-    hpx::apply(from_left_action(), right_.get(), t, std::move(p));
+    trace_scope trace(trace_kind::send_right, U_[0].size() - 1, t);
+    if (account_traffic)
+    {
+        record_traffic(traffic_kind::from_left,
+            hpx::naming::get_locality_id_from_id(right_.get()),
+            serialized_size(t) + id_size());
+    }
+    hpx::apply_p(from_left_action(), right_.get(), send_priority(), t,
+        std::move(p));
+}
+
+partition stepper_server::traced_receive(
+    hpx::future<partition>&& p, trace_kind kind, std::size_t t)
+{
+    std::uint64_t begin = hpx::util::high_resolution_clock::now();
+    return p.then(hpx::launch::sync,
+        [begin, kind, t](hpx::future<partition>&& p) -> partition {
+            record_event(kind, begin, no_partition, t);
+            return p.get();
+        });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -21,34 +63,116 @@ void stepper_server::send_right(std::size_t t, partition p) const
 stepper_server::space stepper_server::do_work(
     std::size_t local_np, std::size_t nx, std::size_t nt, std::uint64_t nd)
 {
+    if (mode == work_mode::coroutine)
+        return do_work_coroutine(local_np, nx, nt);
+    if (mode == work_mode::replay)
+        return do_work_replay(local_np, nx, nt);
+    if (mode == work_mode::tiled)
+        return do_work_tiled(local_np, nx, nt);
+    if (mode == work_mode::spectral)
+        return do_work_spectral(local_np, nx, nt);
+
     // U[t][i] is the state of position i at time t.
     for (space& s : U_)
     {
         s.resize(local_np);
     }
 
+    init_numa_executors();
+
     // Initial conditions: f(0, i) = i
     hpx::id_type here = hpx::naming::get_id_from_locality_id(0);  //hpx::find_here();
     for (std::size_t i = 0; i != local_np; ++i)
     {
-        U_[0][i] = partition(here, nx, double(i));
+        if (ensemble.empty())
+            U_[0][i] = partition(here, nx, double(i));
+        else
+            U_[0][i] = partition(here, ensemble_initial_data(nx, i));
+    }
+
+    // analyze every analysis_interval time steps, starting with the initial
+    // conditions
+    if (analysis_interval != 0)
+    {
+        analysis_.reset(new analysis(
+            hpx::util::format("{}.{}.csv", analysis_file,
+                hpx::get_locality_id()),
+            analysis_queue));
+        analysis_->submit(0, U_[0]);
+    }
+
+    time_loop(local_np, 0, nt, nd, nt / 2);
+
+    // the analysis of the last time steps may still be running
+    if (analysis_)
+    {
+        analysis_->wait();
+        analysis_.reset();
+    }
+
+    return U_[nt % 2];
+}
+
+// Advance the given partitions from time step 't0' by 'nt' time steps, this
+// is one epoch of an elastic run (see elastic.cpp).
+stepper_server::space stepper_server::do_epoch(
+    space initial, std::size_t t0, std::size_t nt, std::uint64_t nd)
+{
+    std::size_t const local_np = initial.size();
+
+    for (space& s : U_)
+    {
+        s.resize(local_np);
     }
+    U_[t0 % 2] = std::move(initial);
+
+    init_numa_executors();
+
+    time_loop(local_np, t0, t0 + nt, nd, std::size_t(-1));
+
+    return U_[(t0 + nt) % 2];
+}
 
+// one executor per NUMA domain, every executor runs the updates of a
+// contiguous range of the local partitions. The executors are created once
+// per stepper, the updates started by the previous call of time_loop (e.g.
+// by the previous epoch of an elastic run) may still be using them.
+void stepper_server::init_numa_executors()
+{
+    if (numa_placement && numa_executors_.empty())
+    {
+        for (hpx::compute::host::target const& domain :
+            hpx::compute::host::numa_domains())
+        {
+            numa_executors_.emplace_back(
+                std::vector<hpx::compute::host::target>{domain});
+        }
+    }
+}
+
+// Compute the time steps [t0, t1) starting from the state U_[t0 % 2]. The
+// local partition 'migrate_step' (if there is one) is migrated in place at
+// time step 'migrate_step'.
+void stepper_server::time_loop(std::size_t local_np, std::size_t t0,
+    std::size_t t1, std::uint64_t nd, std::size_t migrate_step)
+{
     // send initial values to neighbors
-    if (nt != 0)
+    if (t1 != t0)
     {
-        send_left(0, U_[0][0]);
-        send_right(0, U_[0][local_np - 1]);
+        send_left(t0, U_[t0 % 2][0]);
+        send_right(t0, U_[t0 % 2][local_np - 1]);
     }
 
     // limit depth of dependency tree
-    hpx::lcos::local::sliding_semaphore sem(nd);
+    hpx::lcos::local::sliding_semaphore sem(nd, t0);
+    hpx::future<void> signaled;
 
-    for (std::size_t t = 0; t != nt; ++t)
+    for (std::size_t t = t0; t != t1; ++t)
     {
-        if (t == nt / 2)
+        if (t == migrate_step && migrate_step < local_np)
         {
-            U_[0][t] = partition(hpx::components::migrate(U_[0][t], hpx::find_here()));
+            partition& p = U_[t % 2][migrate_step];
+            p = p.migrate(hpx::find_here());
         }
         space const& current = U_[t % 2];
         space& next = U_[(t + 1) % 2];
@@ -56,13 +180,11 @@ stepper_server::space stepper_server::do_work(
         // handle special case (one partition per locality) in a special way
         if (local_np == 1)
         {
-            next[0] = hpx::dataflow(
-                hpx::launch::async, &stepper_server::heat_part,
-                receive_left(t), current[0], receive_right(t)
-            );
+            next[0] = heat_part_async(0, local_np, t, receive_left(t),
+                current[0], receive_right(t));
 
             // send to left and right if not last time step
-            if (t != nt - 1)
+            if (t != t1 - 1)
             {
                 send_left(t + 1, next[0]);
                 send_right(t + 1, next[0]);
@@ -70,36 +192,42 @@ stepper_server::space stepper_server::do_work(
         }
         else
         {
-            next[0] = hpx::dataflow(
-                hpx::launch::async, &stepper_server::heat_part,
-                receive_left(t), current[0], current[1]
-            );
+            next[0] = heat_part_async(
+                0, local_np, t, receive_left(t), current[0], current[1]);
 
             // send to left if not last time step
-            if (t != nt - 1) send_left(t + 1, next[0]);
+            if (t != t1 - 1) send_left(t + 1, next[0]);
 
             for (std::size_t i = 1; i != local_np - 1; ++i)
             {
-                next[i] = hpx::dataflow(
-                    hpx::launch::async, &stepper_server::heat_part,
-                    current[i - 1], current[i], current[i + 1]
-                );
+                next[i] = heat_part_async(i, local_np, t, current[i - 1],
+                    current[i], current[i + 1]);
             }
 
-            next[local_np - 1] = hpx::dataflow(
-                hpx::launch::async, &stepper_server::heat_part,
-                current[local_np - 2], current[local_np - 1], receive_right(t)
-            );
+            next[local_np - 1] = heat_part_async(local_np - 1, local_np, t,
+                current[local_np - 2], current[local_np - 1], receive_right(t));
 
             // send to right if not last time step
-            if (t != nt - 1) send_right(t + 1, next[local_np - 1]);
+            if (t != t1 - 1) send_right(t + 1, next[local_np - 1]);
         }
 
+        if (!ooc_directory.empty())
+        {
+            for (std::size_t i = 0; i != local_np; ++i)
+            {
+                page(next[i],
+                    current[(std::min)(i + ooc_prefetch, local_np - 1)]);
+            }
+        }
+
+        if (analysis_ && (t + 1) % analysis_interval == 0)
+            analysis_->submit(t + 1, next);
+
         // every nd time steps, attach additional continuation which will
         // trigger the semaphore once computation has reached this point
-        if ((t % nd) == 0)
+        if (((t - t0) % nd) == 0)
         {
-            next[0].then(
+            signaled = next[0].then(
                 [&sem, t](partition&&)
                 {
                     // inform semaphore about new lower limit
@@ -109,52 +237,160 @@ stepper_server::space stepper_server::do_work(
 
         // suspend if the tree has become too deep, the continuation above
         // will resume this thread once the computation has caught up
+        trace_scope trace(trace_kind::semaphore_wait, no_partition, t);
         sem.wait(t);
     }
 
-    return U_[nt % 2];
+    // the continuations above refer to the semaphore, the last one runs
+    // after all earlier ones
+    if (signaled.valid())
+        signaled.wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The partitions are updated roughly in the order of their index, partition
+// 'i + ooc_prefetch' of the current time step will be needed shortly after
+// partition 'i' of the next time step has been computed.
+void stepper_server::page(partition const& finished, partition const& ahead)
+{
+    hpx::dataflow(hpx::launch::sync,
+        [](partition finished, partition ahead) {
+            if (std::shared_ptr<partition_server> p = ahead.get_local_ptr())
+                p->prefetch();
+            if (std::shared_ptr<partition_server> p =
+                    finished.get_local_ptr())
+                p->write_back();
+        },
+        finished, ahead);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Schedule the update of the local partition 'i' once its inputs are ready.
+// With NUMA placement enabled, the update runs on the executor of the NUMA
+// domain partition 'i' has been assigned to. The arrays of the new partitions
+// are allocated by these tasks from the pool of this domain and are first
+// written by them as well (see partition_allocator::pool_per_numa_domain),
+// which keeps the data of the partition on its domain from the second time
+// step on.
+hpx::future<partition> stepper_server::heat_part_async(std::size_t i,
+    std::size_t local_np, std::size_t t, partition const& left,
+    partition const& middle, partition const& right)
+{
+    if (!numa_executors_.empty())
+    {
+        numa_executor& exec =
+            numa_executors_[i * numa_executors_.size() / local_np];
+
+        return hpx::dataflow(exec, &stepper_server::heat_part_on<numa_executor>,
+            std::ref(exec), i, t, left, middle, right);
+    }
+
+    // The partitions at both ends are sent to the neighbors, run them (and
+    // all of their continuations) before the interior partitions.
+    hpx::threads::thread_priority priority =
+        hpx::threads::thread_priority_default;
+    if (boundary_priority && (i == 0 || i == local_np - 1))
+        priority = hpx::threads::thread_priority_high;
+
+    return hpx::dataflow(hpx::launch::async_policy(priority),
+        &stepper_server::heat_part, priority, i, t, left, middle, right);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // The partitioned operator, it invokes the heat operator above on all elements
 // of a partition.
-partition stepper_server::heat_part(
-    partition const& left, partition const& middle, partition const& right)
+partition stepper_server::heat_part(hpx::threads::thread_priority priority,
+    std::size_t i, std::size_t t, partition const& left,
+    partition const& middle, partition const& right)
+{
+    hpx::launch::async_policy policy(priority);
+    return heat_part_on(policy, i, t, left, middle, right);
+}
+
+// Use the given executor (or launch policy) for all continuations
+template <typename Executor>
+partition stepper_server::heat_part_on(Executor& exec, std::size_t i,
+    std::size_t t, partition const& left, partition const& middle,
+    partition const& right)
 {
+    // If all three partitions are local, access their data directly and
+    // perform the whole update synchronously, this avoids the address
+    // resolution, action invocation and futures involved otherwise.
+    std::shared_ptr<partition_server> l = left.get_local_ptr();
+    std::shared_ptr<partition_server> m = middle.get_local_ptr();
+    std::shared_ptr<partition_server> r = right.get_local_ptr();
+    if (l && m && r)
+    {
+        partition_data ld = l->get_data(partition_server::left_partition);
+        partition_data md = m->get_data(partition_server::middle_partition);
+        partition_data rd = r->get_data(partition_server::right_partition);
+
+        if (quiescent(ld, md, rd))
+            return middle;
+
+        partition_data next =
+            partition_data::with_members(md.size(), md.members());
+
+        {
+            trace_scope trace(trace_kind::interior, i, t);
+            heat_interior(md, next);
+        }
+
+        trace_scope trace(trace_kind::boundary, i, t);
+        heat_boundary(ld, md, rd, next);
+
+        if (skip_quiescent)
+            next.activity(max_change(md, next));
+
+        // 'middle' is local, thus the new partition is local as well
+        if (migrate_on_access)
+            return middle.successor(next);
+        return partition(hpx::local_new<partition_server>(next));
+    }
+
+    // The update of a partition with remote neighbors is skipped once all
+    // of its inputs have arrived, the interior is computed regardless.
     hpx::shared_future<partition_data> middle_data =
         middle.get_data(partition_server::middle_partition);
 
     hpx::future<partition_data> next_middle =
-        middle_data.then(hpx::util::unwrapping(
-            [middle](partition_data const& m) -> partition_data {
+        middle_data.then(exec, hpx::util::unwrapping(
+            [middle, i, t](partition_data const& m) -> partition_data {
                 HPX_UNUSED(middle);
+                trace_scope trace(trace_kind::interior, i, t);
 
                 // All local operations are performed once the middle data of
                 // the previous time step becomes available.
-                std::size_t size = m.size();
-                partition_data next(size);
-                for (std::size_t i = 1; i != size - 1; ++i)
-                {
-                    next[i] = heat(m[i - 1], m[i], m[i + 1]);
-                }
+                partition_data next =
+                    partition_data::with_members(m.size(), m.members());
+                heat_interior(m, next);
                 return next;
             }));
 
-    return hpx::dataflow(hpx::launch::async,
+    return hpx::dataflow(exec,
         hpx::util::unwrapping(
-            [left, middle, right](partition_data next, partition_data const& l,
-                partition_data const& m, partition_data const& r) -> partition {
+            [left, middle, right, i, t](partition_data next,
+                partition_data const& l, partition_data const& m,
+                partition_data const& r) -> partition {
                     HPX_UNUSED(left);
                     HPX_UNUSED(right);
 
+                    if (quiescent(l, m, r))
+                        return middle;
+
+                    trace_scope trace(trace_kind::boundary, i, t);
+
                     // Calculate the missing boundary elements once the
                     // corresponding data has become available.
-                    std::size_t size = m.size();
-                    next[0] = heat(l[size - 1], m[0], m[1]);
-                    next[size - 1] = heat(m[size - 2], m[size - 1], r[0]);
+                    heat_boundary(l, m, r, next);
+
+                    if (skip_quiescent)
+                        next.activity(max_change(m, next));
 
                     // The new partition_data will be allocated on the same locality
                     // as 'middle'.
+                    if (migrate_on_access)
+                        return middle.successor(next);
                     return partition(middle.get_id(), next);
             }),
         std::move(next_middle),
@@ -163,6 +399,118 @@ partition stepper_server::heat_part(
                 right.get_data(partition_server::right_partition));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// With more than one ensemble member the values of all members at one point
+// are stored next to each other. The innermost loops run over the members,
+// i.e. over contiguous memory, with a separate coefficient for every member.
+void stepper_server::heat_interior(
+    partition_data const& m, partition_data& next)
+{
+    std::size_t const size = m.size();
+    std::size_t const members = m.members();
+
+    if (ensemble.empty())
+    {
+        for (std::size_t j = 1; j != size - 1; ++j)
+        {
+            next[j] = heat(m[j - 1], m[j], m[j + 1]);
+        }
+        return;
+    }
+
+    HPX_ASSERT(ensemble_coefficients.size() == members);
+    double const* c = ensemble_coefficients.data();
+    double const* u = m.data();
+    double* w = next.data();
+
+    for (std::size_t j = members; j != (size - 1) * members; j += members)
+    {
+        double const* left = u + j - members;
+        double const* middle = u + j;
+        double const* right = u + j + members;
+        for (std::size_t q = 0; q != members; ++q)
+        {
+            w[j + q] = middle[q] +
+                c[q] * (left[q] - 2 * middle[q] + right[q]);
+        }
+    }
+}
+
+void stepper_server::heat_boundary(partition_data const& l,
+    partition_data const& m, partition_data const& r, partition_data& next)
+{
+    std::size_t const size = m.size();
+    std::size_t const members = m.members();
+
+    if (ensemble.empty())
+    {
+        next[0] = heat(l[size - 1], m[0], m[1]);
+        next[size - 1] = heat(m[size - 2], m[size - 1], r[0]);
+        return;
+    }
+
+    double const* c = ensemble_coefficients.data();
+    for (std::size_t q = 0; q != members; ++q)
+    {
+        next(0, q) = m(0, q) +
+            c[q] * (l(size - 1, q) - 2 * m(0, q) + m(1, q));
+        next(size - 1, q) = m(size - 1, q) +
+            c[q] * (m(size - 2, q) - 2 * m(size - 1, q) + r(0, q));
+    }
+}
+
+// A partition does not change if neither it nor the boundary elements of its
+// neighbors changed during the last update. With a threshold of zero this is
+// exact, larger thresholds trade accuracy for skipping more updates. The
+// activity of a boundary element is the activity of the partition it belongs
+// to, which makes a partition wake up as soon as one of its neighbors does.
+bool stepper_server::quiescent(partition_data const& l,
+    partition_data const& m, partition_data const& r)
+{
+    if (!skip_quiescent || m.activity() > activity_threshold ||
+        l.activity() > activity_threshold ||
+        r.activity() > activity_threshold)
+    {
+        return false;
+    }
+
+    ++skipped_updates();
+    return true;
+}
+
+double stepper_server::max_change(
+    partition_data const& m, partition_data const& next)
+{
+    std::size_t const size = m.size() * m.members();
+    double const* u = m.data();
+    double const* w = next.data();
+
+    double change = 0.0;
+    for (std::size_t j = 0; j != size; ++j)
+    {
+        change = (std::max)(change, std::abs(w[j] - u[j]));
+    }
+    return change;
+}
+
+partition_data stepper_server::ensemble_initial_data(
+    std::size_t nx, std::size_t i)
+{
+    std::size_t const members = ensemble.size();
+    partition_data data = partition_data::with_members(nx, members);
+
+    // member 'q' starts from the initial conditions f(0, i) = i scaled by
+    // the factor given for this member
+    for (std::size_t j = 0; j != nx; ++j)
+    {
+        for (std::size_t q = 0; q != members; ++q)
+        {
+            data(j, q) = ensemble[q].scale * double(i * nx + j);
+        }
+    }
+    return data;
+}
+
 // The macros below are necessary to generate the code required for exposing
 // our partition type remotely.
 //
@@ -179,6 +527,15 @@ HPX_REGISTER_ACTION(from_left_action);
 
 HPX_REGISTER_ACTION(do_work_action);
 
+HPX_REGISTER_ACTION(set_topology_action);
+
+HPX_REGISTER_ACTION(set_neighbors_action);
+
+HPX_REGISTER_ACTION(do_epoch_action);
+
+HPX_REGISTER_ACTION(get_partitions_action);
+
 HPX_REGISTER_ACTION(release_dependencies_action);
 
 HPX_REGISTER_GATHER(stepper_server::space, stepper_server_space_gatherer);
+HPX_REGISTER_GATHER(stepper_info, stepper_info_gatherer);
@@ -1,15 +1,38 @@
 #if !defined(STEPPER_SERVER_HPP_)
 #define STEPPER_SERVER_HPP_
 
+#include "analysis.hpp"
 #include "defs.hpp"
+#include "halo_mailbox.hpp"
+#include "halo_slot.hpp"
 #include "options.hpp"
 #include "partition.hpp"
+#include "trace.hpp"
 
 #include <hpx/include/actions.hpp>
+#include <hpx/include/compute.hpp>
+#include <hpx/include/threads.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <memory>
+#include <utility>
 #include <vector>
 
+///////////////////////////////////////////////////////////////////////////////
+// Information about a stepper collected from all localities during startup
+struct stepper_info
+{
+    hpx::id_type id;
+    double weight;    // relative speed of the locality
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        ar & id & weight;
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // Data for one time step on one locality
 struct stepper_server : hpx::components::component_base<stepper_server>
@@ -17,15 +40,23 @@ struct stepper_server : hpx::components::component_base<stepper_server>
     // Our data for one time step
     using space = std::vector<partition>;
 
-    stepper_server() {}
+    // The ids of the neighbors and the number of partitions of every
+    // locality become available once set_topology has been called during
+    // startup (see stepper::stepper).
+    stepper_server()
+      : U_(2)
+    {
+        left_ = left_promise_.get_future();
+        right_ = right_promise_.get_future();
+        partitions_ = partitions_promise_.get_future();
 
-    stepper_server(std::size_t nl)
-      : left_(hpx::find_from_basename(
-            stepper_basename, idx(hpx::get_locality_id(), -1, nl)))
-      , right_(hpx::find_from_basename(
-            stepper_basename, idx(hpx::get_locality_id(), +1, nl)))
-      , U_(2)
-    {}
+        if (use_mailbox)
+        {
+            left_mailbox_.reset(new halo_mailbox<partition>(mailbox_capacity));
+            right_mailbox_.reset(
+                new halo_mailbox<partition>(mailbox_capacity));
+        }
+    }
 
     static inline std::size_t idx(std::size_t i, int dir, std::size_t size)
     {
@@ -46,30 +77,79 @@ struct stepper_server : hpx::components::component_base<stepper_server>
 
     HPX_DEFINE_COMPONENT_ACTION(stepper_server, do_work);
 
+    // Advance the given local partitions from time step 't0' by 'nt' time
+    // steps (dataflow implementation), this is used by elastic runs.
+    space do_epoch(
+        space initial, std::size_t t0, std::size_t nt, std::uint64_t nd);
+
+    HPX_DEFINE_COMPONENT_ACTION(stepper_server, do_epoch);
+
     // receive the left-most partition from the right
     void from_right(std::size_t t, partition p)
     {
-        right_receive_buffer_.store_received(t, std::move(p));
+        if (right_mailbox_)
+            right_mailbox_->store_received(t, std::move(p));
+        else
+            right_receive_buffer_.store_received(t, std::move(p));
     }
 
     // receive the right-most partition from the left
     void from_left(std::size_t t, partition p)
     {
-        left_receive_buffer_.store_received(t, std::move(p));
+        if (left_mailbox_)
+            left_mailbox_->store_received(t, std::move(p));
+        else
+            left_receive_buffer_.store_received(t, std::move(p));
     }
 
     HPX_DEFINE_COMPONENT_ACTION(stepper_server, from_right);
     HPX_DEFINE_COMPONENT_ACTION(stepper_server, from_left);
 
+    // wire up this stepper with its neighbors and tell it about the number
+    // of partitions assigned to each of the localities
+    void set_topology(hpx::id_type left, hpx::id_type right,
+        std::vector<std::size_t> partitions)
+    {
+        left_promise_.set_value(std::move(left));
+        right_promise_.set_value(std::move(right));
+        partitions_promise_.set_value(std::move(partitions));
+    }
+
+    HPX_DEFINE_COMPONENT_ACTION(stepper_server, set_topology);
+
+    // replace the neighbors of this stepper, this is used when the set of
+    // localities participating in an elastic run changes between epochs
+    void set_neighbors(hpx::id_type left, hpx::id_type right)
+    {
+        left_ = hpx::make_ready_future(std::move(left));
+        right_ = hpx::make_ready_future(std::move(right));
+    }
+
+    HPX_DEFINE_COMPONENT_ACTION(stepper_server, set_neighbors);
+
+    // return the number of partitions assigned to each of the localities
+    std::vector<std::size_t> get_partitions() const
+    {
+        return partitions_.get();
+    }
+
+    HPX_DEFINE_COMPONENT_ACTION(stepper_server, get_partitions);
+
     // release dependencies
     void release_dependencies()
     {
         left_ = hpx::shared_future<hpx::id_type>();
         right_ = hpx::shared_future<hpx::id_type>();
+        left_promise_ = hpx::lcos::local::promise<hpx::id_type>();
+        right_promise_ = hpx::lcos::local::promise<hpx::id_type>();
     }
 
     HPX_DEFINE_COMPONENT_ACTION(stepper_server, release_dependencies);
 
+    // Create the initial conditions of the local partition 'i' for all
+    // members of an ensemble run.
+    static partition_data ensemble_initial_data(std::size_t nx, std::size_t i);
+
 protected:
     // Our operator
     static double heat(double left, double middle, double right)
@@ -77,32 +157,170 @@ protected:
         return middle + (k * dt / (dx * dx)) * (left - 2 * middle + right);
     }
 
+    // Apply the heat operator to the interior points of 'm', or to its first
+    // and last point (using the boundary elements 'l' and 'r' of the
+    // neighboring partitions), for all ensemble members stored in 'm'.
+    static void heat_interior(partition_data const& m, partition_data& next);
+    static void heat_boundary(partition_data const& l, partition_data const& m,
+        partition_data const& r, partition_data& next);
+
+    // Activity based skipping (see --skip-quiescent): the update of 'm' is
+    // skipped if neither 'm' nor its neighbors changed by more than the
+    // activity threshold during their last update, 'm' is forwarded to the
+    // next time step unchanged instead. max_change returns the activity of
+    // the partition 'next' computed from 'm'.
+    static bool quiescent(partition_data const& l, partition_data const& m,
+        partition_data const& r);
+    static double max_change(partition_data const& m,
+        partition_data const& next);
+
+    // Out-of-core mode: once the partition 'finished' has been computed,
+    // start writing it back and start reading the partition 'ahead' which
+    // is needed a few updates later.
+    static void page(partition const& finished, partition const& ahead);
+
     // The partitioned operator, it invokes the heat operator above on all
-    // elements of a partition.
-    static partition heat_part(
-        partition const& left, partition const& middle, partition const& right);
+    // elements of a partition. All continuations run with the given
+    // priority. 'i' and 't' (the local partition index and the time step)
+    // are used for tracing only.
+    static partition heat_part(hpx::threads::thread_priority priority,
+        std::size_t i, std::size_t t, partition const& left,
+        partition const& middle, partition const& right);
+
+    template <typename Executor>
+    static partition heat_part_on(Executor& exec, std::size_t i, std::size_t t,
+        partition const& left, partition const& middle,
+        partition const& right);
+
+    // The dataflow implementation of the time step loop, see do_work
+    void init_numa_executors();
+    void time_loop(std::size_t local_np, std::size_t t0, std::size_t t1,
+        std::uint64_t nd, std::size_t migrate_step);
+
+    // Schedule heat_part for the local partition 'i' at time step 't' once
+    // all of its inputs have become ready.
+    hpx::future<partition> heat_part_async(std::size_t i, std::size_t local_np,
+        std::size_t t, partition const& left, partition const& middle,
+        partition const& right);
+
+    // Alternative implementation of do_work running one coroutine per
+    // partition (see stepper_server_coroutine.cpp).
+    space do_work_coroutine(std::size_t local_np, std::size_t nx, std::size_t nt);
+
+    // Advance partition 'i' over all 'nt' time steps, exchanging the boundary
+    // elements with the neighboring partitions once per step.
+    hpx::future<void> heat_part_loop(
+        std::size_t i, std::size_t local_np, std::size_t nx, std::size_t nt);
+
+    // Alternative implementation of do_work which captures the dependency
+    // graph of one time step once and replays it for every time step (see
+    // stepper_server_replay.cpp).
+    space do_work_replay(std::size_t local_np, std::size_t nx, std::size_t nt);
+
+    // Re-arm node 'i' for time step 't', run it, and notify it about one of
+    // its inputs for time step 't' having become available.
+    void arm_node(std::size_t i, std::size_t t);
+    void run_node(std::size_t i, std::size_t t);
+    void node_input_ready(std::size_t i, std::size_t t);
+
+    // Alternative implementation of do_work which advances all local
+    // partitions by several time steps per pass over cache sized tiles (see
+    // stepper_server_tiled.cpp).
+    space do_work_tiled(std::size_t local_np, std::size_t nx, std::size_t nt);
+
+    // Alternative implementation of do_work which computes the state after
+    // 'nt' time steps at once by a distributed FFT (see
+    // stepper_server_spectral.cpp).
+    space do_work_spectral(
+        std::size_t local_np, std::size_t nx, std::size_t nt);
+
+    // Advance the grid points which do not depend on the neighboring
+    // localities, and the ones close to the boundaries, by 'steps' time steps.
+    static void heat_tiles(std::vector<double> const& u, std::vector<double>& w,
+        std::size_t steps, std::size_t size);
+    void heat_boundaries(std::vector<double> const& u, std::vector<double>& w,
+        std::size_t t, std::size_t steps);
+
+    // One node of the captured time step graph, i.e. one partition. The
+    // counters of outstanding inputs and the data are kept for two
+    // consecutive time steps.
+    struct replay_node
+    {
+        std::vector<std::size_t> successors;
+        std::size_t num_inputs = 0;
+        std::atomic<std::size_t> pending[2];
+        partition_data data[2];
+    };
 
     // Helper functions to receive the left and right boundary elements from
     // the neighbors.
     partition receive_left(std::size_t t)
     {
-        return left_receive_buffer_.receive(t);
+        hpx::future<partition> p = left_mailbox_ ?
+            left_mailbox_->receive(t) :
+            left_receive_buffer_.receive(t);
+        if (tracing)
+            return traced_receive(std::move(p), trace_kind::receive_left, t);
+        return p;
     }
     partition receive_right(std::size_t t)
     {
-        return right_receive_buffer_.receive(t);
+        hpx::future<partition> p = right_mailbox_ ?
+            right_mailbox_->receive(t) :
+            right_receive_buffer_.receive(t);
+        if (tracing)
+            return traced_receive(std::move(p), trace_kind::receive_right, t);
+        return p;
     }
 
+    // Record the time from requesting a partition from a neighbor until it
+    // has been received.
+    static partition traced_receive(
+        hpx::future<partition>&& p, trace_kind kind, std::size_t t);
+
     // Helper functions to send our left and right boundary elements to
     // the neighbors.
-    inline void send_left(std::size_t t, partition p) const;
-    inline void send_right(std::size_t t, partition p) const;
+    void send_left(std::size_t t, partition p) const;
+    void send_right(std::size_t t, partition p) const;
+
+    static hpx::threads::thread_priority send_priority()
+    {
+        return boundary_priority ? hpx::threads::thread_priority_high :
+                                   hpx::threads::thread_priority_default;
+    }
 
 private:
+    hpx::lcos::local::promise<hpx::id_type> left_promise_, right_promise_;
     hpx::shared_future<hpx::id_type> left_, right_;
+    hpx::lcos::local::promise<std::vector<std::size_t>> partitions_promise_;
+    hpx::shared_future<std::vector<std::size_t>> partitions_;
+
+    // executors bound to the NUMA domains of this locality
+    using numa_executor = hpx::compute::host::block_executor<>;
+    std::vector<numa_executor> numa_executors_;
     std::vector<space> U_;
     hpx::lcos::local::receive_buffer<partition> left_receive_buffer_;
     hpx::lcos::local::receive_buffer<partition> right_receive_buffer_;
+
+    // in-situ analysis of the local partitions (see --analyze-every)
+    std::unique_ptr<analysis> analysis_;
+
+    // lock-free replacements of the receive buffers above (see --mailbox)
+    std::unique_ptr<halo_mailbox<partition>> left_mailbox_;
+    std::unique_ptr<halo_mailbox<partition>> right_mailbox_;
+
+    // boundary elements exchanged between the local partitions by the
+    // coroutine based time step loop
+    std::unique_ptr<halo_slot<double>[]> from_left_;
+    std::unique_ptr<halo_slot<double>[]> from_right_;
+
+    // state of the replayed time step graph
+    std::unique_ptr<replay_node[]> nodes_;
+    std::size_t num_nodes_ = 0;
+    std::size_t num_steps_ = 0;
+    double halo_left_[2];
+    double halo_right_[2];
+    std::unique_ptr<hpx::lcos::local::latch> nodes_done_;
 };
 
 // The macros below are necessary to generate the code required for exposing
@@ -120,9 +338,22 @@ HPX_REGISTER_ACTION_DECLARATION(from_left_action);
 using do_work_action = stepper_server::do_work_action;
 HPX_REGISTER_ACTION_DECLARATION(do_work_action);
 
+using set_topology_action = stepper_server::set_topology_action;
+HPX_REGISTER_ACTION_DECLARATION(set_topology_action);
+
+using set_neighbors_action = stepper_server::set_neighbors_action;
+HPX_REGISTER_ACTION_DECLARATION(set_neighbors_action);
+
+using do_epoch_action = stepper_server::do_epoch_action;
+HPX_REGISTER_ACTION_DECLARATION(do_epoch_action);
+
+using get_partitions_action = stepper_server::get_partitions_action;
+HPX_REGISTER_ACTION_DECLARATION(get_partitions_action);
+
 using release_dependencies_action = stepper_server::release_dependencies_action;
 HPX_REGISTER_ACTION_DECLARATION(release_dependencies_action);
 
 HPX_REGISTER_GATHER_DECLARATION(stepper_server::space, stepper_server_space_gatherer);
+HPX_REGISTER_GATHER_DECLARATION(stepper_info, stepper_info_gatherer);
 
 #endif    // STEPPER_SERVER_HPP_
@@ -0,0 +1,170 @@
+#include "stepper_server.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/throw_exception.hpp>
+
+#if defined(HPX_HAVE_AWAIT)
+#include <hpx/lcos/detail/future_await_traits.hpp>
+#endif
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(HPX_HAVE_AWAIT)
+///////////////////////////////////////////////////////////////////////////////
+// This is the coroutine based implementation of the time step loop
+//
+// Instead of building a new dataflow graph for every time step, every
+// partition is advanced by a single coroutine which runs over all time steps.
+// The coroutine keeps the data of its partition locally and only exchanges
+// the boundary elements with its neighbors. This replaces the futures and
+// continuations created by heat_part for every partition and time step with
+// a fixed slot per neighbor (see halo_slot).
+stepper_server::space stepper_server::do_work_coroutine(
+    std::size_t local_np, std::size_t nx, std::size_t nt)
+{
+    // U[t][i] is the state of position i at time t.
+    for (space& s : U_)
+    {
+        s.resize(local_np);
+    }
+
+    from_left_.reset(new halo_slot<double>[local_np]);
+    from_right_.reset(new halo_slot<double>[local_np]);
+
+    std::vector<hpx::future<void>> loops;
+    loops.reserve(local_np);
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        loops.push_back(heat_part_loop(i, local_np, nx, nt));
+    }
+
+    for (hpx::future<void>& f : hpx::when_all(std::move(loops)).get())
+    {
+        f.get();    // rethrow exceptions
+    }
+
+    return U_[nt % 2];
+}
+
+hpx::future<void> stepper_server::heat_part_loop(
+    std::size_t i, std::size_t local_np, std::size_t nx, std::size_t nt)
+{
+    // Initial conditions: f(0, i) = i
+    partition_data current(nx, double(i));
+
+    // The partitions at the ends of the local range send their boundary
+    // elements to the neighboring localities as single element partitions.
+    // These are created once and overwritten in every time step. A neighbor
+    // may still read the one of the previous time step, therefore every end
+    // alternates between two of them.
+    partition to_left[2], to_right[2];
+    std::shared_ptr<partition_server> to_left_ptr[2], to_right_ptr[2];
+    for (std::size_t k = 0; k != 2; ++k)
+    {
+        if (i == 0)
+        {
+            to_left[k] = partition(hpx::find_here(), 1, 0.);
+            co_await to_left[k].share();
+            to_left_ptr[k] = co_await hpx::get_ptr<partition_server>(
+                to_left[k].get_id());
+        }
+        if (i == local_np - 1)
+        {
+            to_right[k] = partition(hpx::find_here(), 1, 0.);
+            co_await to_right[k].share();
+            to_right_ptr[k] = co_await hpx::get_ptr<partition_server>(
+                to_right[k].get_id());
+        }
+    }
+
+    for (std::size_t t = 0; t != nt; ++t)
+    {
+        // make our boundary elements available to our neighbors
+        if (i == 0)
+        {
+            to_left_ptr[t % 2]->store_value(current[0]);
+            send_left(t, to_left[t % 2]);
+        }
+        if (i == local_np - 1)
+        {
+            to_right_ptr[t % 2]->store_value(current[nx - 1]);
+            send_right(t, to_right[t % 2]);
+        }
+        if (i != 0)
+            from_right_[i - 1].store_received(t, double(current[0]));
+        if (i != local_np - 1)
+            from_left_[i + 1].store_received(t, double(current[nx - 1]));
+
+        // wait for the boundary elements of our neighbors
+        double left = 0.;
+        if (i == 0)
+        {
+            partition p = receive_left(t);
+            co_await p.share();    // get_data would block until p is ready
+            partition_data l =
+                co_await p.get_data(partition_server::left_partition);
+            left = l[l.size() - 1];
+        }
+        else
+        {
+            left = co_await from_left_[i].receive(t);
+        }
+
+        double right = 0.;
+        if (i == local_np - 1)
+        {
+            partition p = receive_right(t);
+            co_await p.share();    // get_data would block until p is ready
+            partition_data r =
+                co_await p.get_data(partition_server::right_partition);
+            right = r[0];
+        }
+        else
+        {
+            right = co_await from_right_[i].receive(t);
+        }
+
+        partition_data next(nx);
+        {
+            trace_scope trace(trace_kind::interior, i, t);
+            for (std::size_t j = 1; j != nx - 1; ++j)
+            {
+                next[j] = heat(current[j - 1], current[j], current[j + 1]);
+            }
+        }
+        {
+            trace_scope trace(trace_kind::boundary, i, t);
+            next[0] = heat(left, current[0], current[1]);
+            next[nx - 1] = heat(current[nx - 2], current[nx - 1], right);
+        }
+
+        current = std::move(next);
+    }
+
+    U_[nt % 2][i] = partition(hpx::find_here(), current);
+}
+
+#else
+
+stepper_server::space stepper_server::do_work_coroutine(
+    std::size_t, std::size_t, std::size_t)
+{
+    HPX_THROW_EXCEPTION(hpx::not_implemented,
+        "stepper_server::do_work_coroutine",
+        "the coroutine based time step loop requires HPX to be built with "
+        "HPX_WITH_AWAIT=On");
+    return space();
+}
+
+hpx::future<void> stepper_server::heat_part_loop(
+    std::size_t, std::size_t, std::size_t, std::size_t)
+{
+    return hpx::make_ready_future();
+}
+
+#endif
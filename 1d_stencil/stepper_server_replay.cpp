@@ -0,0 +1,202 @@
+#include "stepper_server.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// This is the capture and replay implementation of the time step loop
+//
+// The dependency structure of every time step is the same: partition 'i' at
+// time step 't + 1' depends on the partitions 'i - 1', 'i', and 'i + 1' at
+// time step 't' (and on the boundary elements received from the neighboring
+// localities for the partitions at both ends). This structure is captured
+// once as a set of nodes, each knowing its successors and its number of
+// inputs. Every time step then just re-arms the counters of outstanding
+// inputs of the preallocated nodes. A node is scheduled as soon as its last
+// input arrived, no futures or continuations are created for the local
+// dependencies.
+stepper_server::space stepper_server::do_work_replay(
+    std::size_t local_np, std::size_t nx, std::size_t nt)
+{
+    // U[t][i] is the state of position i at time t.
+    for (space& s : U_)
+    {
+        s.resize(local_np);
+    }
+
+    // capture the graph of one time step
+    nodes_.reset(new replay_node[local_np]);
+    num_nodes_ = local_np;
+    num_steps_ = nt;
+    nodes_done_.reset(new hpx::lcos::local::latch(local_np + 1));
+
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        replay_node& n = nodes_[i];
+
+        if (i != 0)
+            n.successors.push_back(i - 1);
+        n.successors.push_back(i);
+        if (i != local_np - 1)
+            n.successors.push_back(i + 1);
+
+        // the inputs of a node are the nodes it is a successor of and the
+        // boundary elements received from the neighboring localities
+        n.num_inputs = n.successors.size() + (i == 0) + (i == local_np - 1);
+
+        // Initial conditions: f(0, i) = i
+        n.data[0] = partition_data(nx, double(i));
+        n.data[1] = partition_data(nx);
+    }
+
+    // send initial values to neighbors
+    if (nt != 0)
+    {
+        send_left(0, partition(hpx::find_here(), nodes_[0].data[0]));
+        send_right(0,
+            partition(hpx::find_here(), nodes_[local_np - 1].data[0]));
+    }
+
+    // Arm the first two time steps. The local inputs of the first time step
+    // are the initial values, only the boundary elements have to arrive.
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        replay_node& n = nodes_[i];
+        n.pending[0] = n.num_inputs - n.successors.size() + 1;
+        n.pending[1] = n.num_inputs;
+    }
+
+    if (nt != 0)
+    {
+        for (std::size_t i = 0; i != local_np; ++i)
+        {
+            arm_node(i, 0);
+            if (nt > 1)
+                arm_node(i, 1);
+        }
+
+        // release the extra input held back above, this schedules all
+        // nodes which do not depend on any boundary elements
+        for (std::size_t i = 0; i != local_np; ++i)
+        {
+            node_input_ready(i, 0);
+        }
+    }
+    else
+    {
+        nodes_done_->count_down(local_np);
+    }
+
+    nodes_done_->count_down_and_wait();
+
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        U_[nt % 2][i] = partition(hpx::find_here(), nodes_[i].data[nt % 2]);
+    }
+
+    nodes_.reset();
+    nodes_done_.reset();
+
+    return U_[nt % 2];
+}
+
+// Wait for the boundary elements node 'i' needs for time step 't' from the
+// neighboring localities. The counter of outstanding inputs has to be set
+// before calling this.
+void stepper_server::arm_node(std::size_t i, std::size_t t)
+{
+    if (i == 0)
+    {
+        receive_left(t).then([this, t](partition&& p) {
+            partition_data d =
+                p.get_data(partition_server::left_partition).get();
+            halo_left_[t % 2] = d[d.size() - 1];
+            node_input_ready(0, t);
+        });
+    }
+    if (i == num_nodes_ - 1)
+    {
+        receive_right(t).then([this, t](partition&& p) {
+            partition_data d =
+                p.get_data(partition_server::right_partition).get();
+            halo_right_[t % 2] = d[0];
+            node_input_ready(num_nodes_ - 1, t);
+        });
+    }
+}
+
+void stepper_server::node_input_ready(std::size_t i, std::size_t t)
+{
+    if (--nodes_[i].pending[t % 2] == 0)
+    {
+        hpx::apply(&stepper_server::run_node, this, i, t);
+    }
+}
+
+// Compute time step 't' of node 'i', i.e. the state at time 't + 1'
+void stepper_server::run_node(std::size_t i, std::size_t t)
+{
+    replay_node& n = nodes_[i];
+
+    std::size_t const cur = t % 2;
+    std::size_t const nxt = (t + 1) % 2;
+
+    // The data sent to the neighboring localities is referenced by the sent
+    // partition, the nodes at both ends therefore use fresh buffers.
+    partition_data const& m = n.data[cur];
+    std::size_t const size = m.size();
+    if (i == 0 || i == num_nodes_ - 1)
+        n.data[nxt] = partition_data(size);
+    partition_data& next = n.data[nxt];
+
+    double left = (i == 0) ? halo_left_[cur] : nodes_[i - 1].data[cur][size - 1];
+    double right =
+        (i == num_nodes_ - 1) ? halo_right_[cur] : nodes_[i + 1].data[cur][0];
+
+    {
+        trace_scope trace(trace_kind::interior, i, t);
+        for (std::size_t j = 1; j != size - 1; ++j)
+        {
+            next[j] = heat(m[j - 1], m[j], m[j + 1]);
+        }
+    }
+    {
+        trace_scope trace(trace_kind::boundary, i, t);
+        next[0] = heat(left, m[0], m[1]);
+        next[size - 1] = heat(m[size - 2], m[size - 1], right);
+    }
+
+    // re-arm this node for the time step after the next one, all inputs for
+    // that step depend on this node having finished the current step
+    if (t + 2 < num_steps_)
+    {
+        n.pending[cur] = n.num_inputs;
+        arm_node(i, t + 2);
+    }
+
+    if (t + 1 == num_steps_)
+    {
+        nodes_done_->count_down(1);
+        return;
+    }
+
+    // send to left and right if not last time step
+    if (i == 0 || i == num_nodes_ - 1)
+    {
+        partition p(hpx::find_here(), next);
+        if (i == 0)
+            send_left(t + 1, p);
+        if (i == num_nodes_ - 1)
+            send_right(t + 1, p);
+    }
+
+    for (std::size_t s : n.successors)
+    {
+        node_input_ready(s, t + 1);
+    }
+}
@@ -0,0 +1,313 @@
+#include "stepper_server.hpp"
+#include "fft.hpp"
+#include "reference.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/naming.hpp>
+#include <hpx/throw_exception.hpp>
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// This is the spectral implementation (see --mode=spectral)
+//
+// The grid is periodic and the operator is linear with constant coefficients,
+// every Fourier mode 'k' of the N grid points is therefore multiplied by its
+// amplification factor (see reference.hpp) in every time step. The state
+// after 'nt' steps is computed directly by a distributed FFT of the initial
+// conditions, scaling every mode by the amplification factor raised to the
+// power 'nt', and the inverse FFT.
+//
+// The distributed FFT is the four-step algorithm on the np x nx matrix of
+// the grid points, where row 'n1' is partition 'n1' and the point
+// n = nx * n1 + n2 is stored at (n1, n2). Every locality owns the rows of its
+// partitions and a contiguous range of the columns. The forward transform
+// applies FFTs of length np to the columns, multiplies by the twiddle factors
+// exp(-2 pi i n2 k1 / N), and applies FFTs of length nx to the rows. Mode
+// k = k1 + np * k2 ends up at (k1, k2). The inverse transform applies the
+// same steps in reverse order. The columns and rows are exchanged between
+// all localities four times (all-to-all).
+namespace {
+    using complex = std::complex<double>;
+
+    // Blocks sent to this locality, keyed by phase * num_localities + source
+    hpx::lcos::local::receive_buffer<std::vector<double>> spectral_blocks;
+
+    complex twiddle(std::size_t n2, std::size_t k1, std::size_t n, double sign)
+    {
+        double const angle = 2 * 3.14159265358979323846 *
+            double((n2 * k1) % n) / double(n);
+        return std::polar(1.0, sign * angle);
+    }
+}
+
+void store_spectral_block(std::size_t key, std::vector<double> block)
+{
+    spectral_blocks.store_received(key, std::move(block));
+}
+
+HPX_PLAIN_ACTION(store_spectral_block, store_spectral_block_action);
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    // Send blocks[l] to locality 'l' and return the blocks received from all
+    // localities in this phase. The complex values are sent as pairs of
+    // doubles.
+    std::vector<std::vector<double>> exchange(
+        std::size_t phase, std::vector<std::vector<double>>&& blocks)
+    {
+        std::size_t const nl = blocks.size();
+        std::size_t const here = hpx::get_locality_id();
+
+        for (std::size_t l = 0; l != nl; ++l)
+        {
+            std::size_t const key = phase * nl + here;
+            if (l == here)
+            {
+                store_spectral_block(key, std::move(blocks[l]));
+            }
+            else
+            {
+                hpx::apply(store_spectral_block_action(),
+                    hpx::naming::get_id_from_locality_id(std::uint32_t(l)),
+                    key, std::move(blocks[l]));
+            }
+        }
+
+        std::vector<hpx::future<std::vector<double>>> received;
+        received.reserve(nl);
+        for (std::size_t l = 0; l != nl; ++l)
+        {
+            received.push_back(spectral_blocks.receive(phase * nl + l));
+        }
+
+        std::vector<std::vector<double>> result;
+        result.reserve(nl);
+        for (hpx::future<std::vector<double>>& f : received)
+        {
+            result.push_back(f.get());
+        }
+        return result;
+    }
+
+    // Rows [first_row[l], first_row[l + 1]) and columns [first_col[l],
+    // first_col[l + 1]) are owned by locality 'l'
+    struct layout
+    {
+        std::size_t here;
+        std::size_t np;
+        std::size_t nx;
+        std::vector<std::size_t> first_row;
+        std::vector<std::size_t> first_col;
+
+        std::size_t num_rows(std::size_t l) const
+        {
+            return first_row[l + 1] - first_row[l];
+        }
+        std::size_t num_cols(std::size_t l) const
+        {
+            return first_col[l + 1] - first_col[l];
+        }
+    };
+
+    // The local rows are stored row by row (nx values each), the local
+    // columns column by column (np values each).
+    std::vector<complex> rows_to_columns(layout const& g, std::size_t phase,
+        std::vector<complex> const& rows)
+    {
+        std::size_t const nl = g.first_row.size() - 1;
+        std::size_t const local_rows = g.num_rows(g.here);
+
+        std::vector<std::vector<double>> blocks(nl);
+        for (std::size_t l = 0; l != nl; ++l)
+        {
+            std::vector<double>& block = blocks[l];
+            block.reserve(2 * g.num_cols(l) * local_rows);
+            for (std::size_t c = g.first_col[l]; c != g.first_col[l + 1]; ++c)
+            {
+                for (std::size_t r = 0; r != local_rows; ++r)
+                {
+                    complex const v = rows[r * g.nx + c];
+                    block.push_back(v.real());
+                    block.push_back(v.imag());
+                }
+            }
+        }
+
+        std::vector<std::vector<double>> received =
+            exchange(phase, std::move(blocks));
+
+        std::size_t const local_cols = g.num_cols(g.here);
+        std::vector<complex> columns(local_cols * g.np);
+        for (std::size_t m = 0; m != nl; ++m)
+        {
+            double const* v = received[m].data();
+            for (std::size_t c = 0; c != local_cols; ++c)
+            {
+                for (std::size_t r = g.first_row[m]; r != g.first_row[m + 1];
+                     ++r, v += 2)
+                {
+                    columns[c * g.np + r] = complex(v[0], v[1]);
+                }
+            }
+        }
+        return columns;
+    }
+
+    std::vector<complex> columns_to_rows(layout const& g, std::size_t phase,
+        std::vector<complex> const& columns)
+    {
+        std::size_t const nl = g.first_row.size() - 1;
+        std::size_t const local_cols = g.num_cols(g.here);
+
+        std::vector<std::vector<double>> blocks(nl);
+        for (std::size_t m = 0; m != nl; ++m)
+        {
+            std::vector<double>& block = blocks[m];
+            block.reserve(2 * g.num_rows(m) * local_cols);
+            for (std::size_t r = g.first_row[m]; r != g.first_row[m + 1]; ++r)
+            {
+                for (std::size_t c = 0; c != local_cols; ++c)
+                {
+                    complex const v = columns[c * g.np + r];
+                    block.push_back(v.real());
+                    block.push_back(v.imag());
+                }
+            }
+        }
+
+        std::vector<std::vector<double>> received =
+            exchange(phase, std::move(blocks));
+
+        std::size_t const local_rows = g.num_rows(g.here);
+        std::vector<complex> rows(local_rows * g.nx);
+        for (std::size_t l = 0; l != nl; ++l)
+        {
+            double const* v = received[l].data();
+            for (std::size_t r = 0; r != local_rows; ++r)
+            {
+                for (std::size_t c = g.first_col[l]; c != g.first_col[l + 1];
+                     ++c, v += 2)
+                {
+                    rows[r * g.nx + c] = complex(v[0], v[1]);
+                }
+            }
+        }
+        return rows;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+stepper_server::space stepper_server::do_work_spectral(
+    std::size_t local_np, std::size_t nx, std::size_t nt)
+{
+    if (ensemble.size() > 1)
+    {
+        HPX_THROW_EXCEPTION(hpx::bad_parameter,
+            "stepper_server::do_work_spectral",
+            "the spectral implementation does not support ensembles");
+    }
+
+    // U[t][i] is the state of position i at time t.
+    for (space& s : U_)
+    {
+        s.resize(local_np);
+    }
+
+    // Determine the rows owned by all localities
+    std::size_t const nl = hpx::get_num_localities(hpx::launch::sync);
+
+    layout g;
+    g.here = hpx::get_locality_id();
+    g.nx = nx;
+
+    std::vector<std::vector<double>> counts(
+        nl, std::vector<double>{double(local_np)});
+    counts = exchange(0, std::move(counts));
+
+    g.first_row.push_back(0);
+    g.first_col.push_back(0);
+    for (std::size_t l = 0; l != nl; ++l)
+    {
+        g.first_row.push_back(g.first_row.back() + std::size_t(counts[l][0]));
+        g.first_col.push_back(nx * (l + 1) / nl);
+    }
+    g.np = g.first_row.back();
+
+    std::size_t const n = g.np * nx;
+    std::size_t const first_row = g.first_row[g.here];
+    std::size_t const local_cols = g.num_cols(g.here);
+
+    double const c = ensemble.empty() ? k * dt / (dx * dx) :
+                                        ensemble_coefficients[0];
+    double const scale = ensemble.empty() ? 1.0 : ensemble[0].scale;
+
+    // Initial conditions: f(0, i) = i
+    std::vector<complex> rows(local_np * nx);
+    for (std::size_t i = 0; i != local_np * nx; ++i)
+    {
+        rows[i] = scale * double(i);
+    }
+
+    // forward transform of the columns, twiddle factors
+    std::vector<complex> columns = rows_to_columns(g, 1, rows);
+    for (std::size_t col = 0; col != local_cols; ++col)
+    {
+        complex* v = &columns[col * g.np];
+        fft(v, g.np);
+
+        std::size_t const n2 = g.first_col[g.here] + col;
+        for (std::size_t k1 = 0; k1 != g.np; ++k1)
+        {
+            v[k1] *= twiddle(n2, k1, n, -1.0);
+        }
+    }
+
+    // forward transform of the rows, advance all modes by 'nt' time steps,
+    // inverse transform of the rows, inverse twiddle factors
+    rows = columns_to_rows(g, 2, columns);
+    for (std::size_t row = 0; row != local_np; ++row)
+    {
+        complex* v = &rows[row * nx];
+        fft(v, nx);
+
+        std::size_t const k1 = first_row + row;
+        for (std::size_t k2 = 0; k2 != nx; ++k2)
+        {
+            v[k2] *= std::pow(amplification(k1 + g.np * k2, n, c), double(nt));
+        }
+
+        fft(v, nx, true);
+        for (std::size_t n2 = 0; n2 != nx; ++n2)
+        {
+            v[n2] *= twiddle(n2, k1, n, 1.0);
+        }
+    }
+
+    // inverse transform of the columns
+    columns = rows_to_columns(g, 3, rows);
+    for (std::size_t col = 0; col != local_cols; ++col)
+    {
+        fft(&columns[col * g.np], g.np, true);
+    }
+    rows = columns_to_rows(g, 4, columns);
+
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        partition_data p(nx);
+        for (std::size_t j = 0; j != nx; ++j)
+        {
+            p[j] = rows[i * nx + j].real() / double(n);
+        }
+        U_[nt % 2][i] = partition(hpx::find_here(), p);
+    }
+
+    return U_[nt % 2];
+}
@@ -0,0 +1,157 @@
+#include "stepper_server.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/parallel_for_loop.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// This is the temporally tiled implementation of the time step loop
+//
+// All local partitions are stored as one contiguous array. Every pass over
+// this array advances it by 'tile_steps' time steps at once:
+//
+//  - the grid points at least 'tile_steps' points away from both ends do not
+//    depend on the neighboring localities during the pass. They are split
+//    into tiles of 'tile_size' points, every tile is loaded together with
+//    'tile_steps' ghost points on either side and advanced by all time steps
+//    while it stays in cache. The ghost points are recomputed by both
+//    adjacent tiles, which keeps all tiles independent of each other.
+//
+//  - the 'tile_steps' points at both ends are advanced one time step at a
+//    time (using 2 * 'tile_steps' points) while exchanging the boundary
+//    elements with the neighboring localities once per time step, exactly as
+//    the other implementations do.
+stepper_server::space stepper_server::do_work_tiled(
+    std::size_t local_np, std::size_t nx, std::size_t nt)
+{
+    // U[t][i] is the state of position i at time t.
+    for (space& s : U_)
+    {
+        s.resize(local_np);
+    }
+
+    // Initial conditions: f(0, i) = i
+    std::size_t const size = local_np * nx;
+    std::vector<double> u(size), w(size);
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        u[i] = double(i);
+    }
+
+    for (std::size_t t = 0; t < nt;)
+    {
+        std::size_t steps = (std::min)(tile_steps, nt - t);
+        steps = (std::max)((std::min)(steps, size / 2), std::size_t(1));
+
+        hpx::future<void> tiles = hpx::async(&stepper_server::heat_tiles,
+            std::cref(u), std::ref(w), steps, tile_size);
+
+        heat_boundaries(u, w, t, steps);
+        tiles.get();
+
+        std::swap(u, w);
+        t += steps;
+    }
+
+    for (std::size_t i = 0; i != local_np; ++i)
+    {
+        partition_data p(nx);
+        for (std::size_t j = 0; j != nx; ++j)
+        {
+            p[j] = u[i * nx + j];
+        }
+        U_[nt % 2][i] = partition(hpx::find_here(), p);
+    }
+
+    return U_[nt % 2];
+}
+
+void stepper_server::heat_tiles(std::vector<double> const& u,
+    std::vector<double>& w, std::size_t steps, std::size_t size)
+{
+    std::size_t const first = steps;
+    std::size_t const last = u.size() - steps;
+    if (first >= last)
+        return;
+
+    size = (std::max)(size, std::size_t(1));
+    std::size_t const num_tiles = (last - first + size - 1) / size;
+
+    hpx::parallel::for_loop(hpx::parallel::execution::par, std::size_t(0),
+        num_tiles, [&](std::size_t tile) {
+            std::size_t const begin = first + tile * size;
+            std::size_t const end = (std::min)(begin + size, last);
+
+            // load the tile and its ghost points
+            std::vector<double> current(
+                u.begin() + (begin - steps), u.begin() + (end + steps));
+            std::vector<double> next(current.size());
+
+            // the range of valid points shrinks by one on both ends with
+            // every time step
+            for (std::size_t s = 0; s != steps; ++s)
+            {
+                for (std::size_t i = s + 1; i != current.size() - s - 1; ++i)
+                {
+                    next[i] = heat(current[i - 1], current[i], current[i + 1]);
+                }
+                std::swap(current, next);
+            }
+
+            std::copy(current.begin() + steps, current.end() - steps,
+                w.begin() + begin);
+        });
+}
+
+void stepper_server::heat_boundaries(std::vector<double> const& u,
+    std::vector<double>& w, std::size_t t, std::size_t steps)
+{
+    std::size_t const width = 2 * steps;
+
+    std::vector<double> left(u.begin(), u.begin() + width);
+    std::vector<double> right(u.end() - width, u.end());
+    std::vector<double> next(width);
+
+    for (std::size_t s = 0; s != steps; ++s, ++t)
+    {
+        // send our boundary elements to the neighbors
+        partition_data l(1), r(1);
+        l[0] = left[0];
+        r[0] = right[width - 1];
+        send_left(t, partition(hpx::find_here(), l));
+        send_right(t, partition(hpx::find_here(), r));
+
+        hpx::future<partition_data> left_data =
+            receive_left(t).get_data(partition_server::left_partition);
+        hpx::future<partition_data> right_data =
+            receive_right(t).get_data(partition_server::right_partition);
+
+        // the valid points of the left part are [0, width - s)
+        partition_data ld = left_data.get();
+        next[0] = heat(ld[ld.size() - 1], left[0], left[1]);
+        for (std::size_t i = 1; i != width - s - 1; ++i)
+        {
+            next[i] = heat(left[i - 1], left[i], left[i + 1]);
+        }
+        std::swap(left, next);
+
+        // the valid points of the right part are [s, width)
+        partition_data rd = right_data.get();
+        next[width - 1] = heat(right[width - 2], right[width - 1], rd[0]);
+        for (std::size_t i = s + 1; i != width - 1; ++i)
+        {
+            next[i] = heat(right[i - 1], right[i], right[i + 1]);
+        }
+        std::swap(right, next);
+    }
+
+    std::copy(left.begin(), left.begin() + steps, w.begin());
+    std::copy(right.end() - steps, right.end(), w.end() - steps);
+}
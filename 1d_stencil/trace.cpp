@@ -0,0 +1,160 @@
+#include "trace.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/hpx.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    // The events recorded by one worker thread. Only the owning thread
+    // writes to the buffer, the lock (which is therefore uncontended while
+    // events are recorded) protects it against being read by collect_trace
+    // while a late event is still being recorded.
+    struct trace_ring
+    {
+        explicit trace_ring(std::size_t capacity)
+          : events(capacity)
+          , next(0)
+        {
+        }
+
+        hpx::lcos::local::spinlock mtx;
+        std::vector<trace_event> events;
+        std::size_t next;    // total number of recorded events
+    };
+
+    std::uint64_t trace_epoch = 0;
+
+    std::mutex registry_mtx;
+    std::vector<std::unique_ptr<trace_ring>> registry;
+
+    thread_local trace_ring* ring = nullptr;
+
+    trace_ring& get_ring()
+    {
+        if (ring == nullptr)
+        {
+            std::unique_ptr<trace_ring> r(
+                new trace_ring((std::max)(trace_buffer_size, std::size_t(1))));
+            ring = r.get();
+
+            std::lock_guard<std::mutex> l(registry_mtx);
+            registry.push_back(std::move(r));
+        }
+        return *ring;
+    }
+
+    char const* const trace_names[] = {"interior", "boundary", "send_left",
+        "send_right", "receive_left", "receive_right", "semaphore_wait"};
+
+    char const* const trace_categories[] = {"compute", "compute", "send",
+        "send", "receive", "receive", "wait"};
+}
+
+void start_tracing()
+{
+    trace_epoch = hpx::util::high_resolution_clock::now();
+    tracing = true;
+}
+
+void record_event(trace_kind kind, std::uint64_t begin, std::size_t partition,
+    std::size_t step)
+{
+    std::uint64_t end = hpx::util::high_resolution_clock::now();
+
+    trace_ring& r = get_ring();
+    std::lock_guard<hpx::lcos::local::spinlock> l(r.mtx);
+    if (!tracing)
+        return;    // the event ended after the trace was collected
+
+    trace_event& e = r.events[r.next++ % r.events.size()];
+    e.begin = begin;
+    e.end = end;
+    e.step = step;
+    e.partition = std::uint32_t(partition);
+    e.thread = std::uint32_t(hpx::get_worker_thread_num());
+    e.kind = kind;
+}
+
+std::vector<trace_event> collect_trace()
+{
+    tracing = false;
+
+    std::uint32_t const locality = hpx::get_locality_id();
+    std::vector<trace_event> result;
+
+    std::lock_guard<std::mutex> l(registry_mtx);
+    for (std::unique_ptr<trace_ring>& r : registry)
+    {
+        std::lock_guard<hpx::lcos::local::spinlock> rl(r->mtx);
+        std::size_t const capacity = r->events.size();
+        std::size_t const first = r->next > capacity ? r->next - capacity : 0;
+        for (std::size_t i = first; i != r->next; ++i)
+        {
+            trace_event e = r->events[i % capacity];
+            if (e.begin < trace_epoch)
+                continue;    // recorded before tracing was (re-)started
+
+            e.begin -= trace_epoch;
+            e.end -= trace_epoch;
+            e.locality = locality;
+            result.push_back(e);
+        }
+        r->next = 0;
+    }
+    return result;
+}
+
+HPX_REGISTER_ACTION(collect_trace_action);
+
+///////////////////////////////////////////////////////////////////////////////
+// Every locality is shown as a separate process and every worker thread as
+// a separate thread of that process. The timestamps of different localities
+// are relative to the start of tracing on each of them.
+void write_trace(std::string const& filename,
+    std::vector<std::vector<trace_event>> const& events)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::cerr << "Unable to write trace file: " << filename << std::endl;
+        return;
+    }
+
+    out << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    for (std::size_t l = 0; l != events.size(); ++l)
+    {
+        hpx::util::format_to(out,
+            "{}{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},"
+            "\"args\":{{\"name\":\"locality {}\"}}}}",
+            first ? "" : ",\n", l, l);
+        first = false;
+
+        for (trace_event const& e : events[l])
+        {
+            std::size_t const kind = std::size_t(e.kind);
+            hpx::util::format_to(out,
+                ",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\","
+                "\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{},"
+                "\"args\":{{\"step\":{}",
+                trace_names[kind], trace_categories[kind], e.begin / 1e3,
+                (e.end - e.begin) / 1e3, e.locality, e.thread, e.step);
+            if (e.partition != no_partition)
+                hpx::util::format_to(out, ",\"partition\":{}", e.partition);
+            out << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+}
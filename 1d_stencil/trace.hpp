@@ -0,0 +1,101 @@
+#if !defined(TRACE_HPP_)
+#define TRACE_HPP_
+
+#include "options.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/serialization.hpp>
+#include <hpx/include/util.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Opt-in tracing of the time step loop (see --trace). Every worker thread
+// records its events into its own ring buffer, which keeps the most recent
+// 'trace_buffer_size' events. The events of all localities are collected by
+// locality 0 at the end of the run and written as a Chrome trace (JSON)
+// which can be loaded into chrome://tracing or https://ui.perfetto.dev.
+enum class trace_kind : std::uint8_t
+{
+    interior,         // heat_part: update of the interior points
+    boundary,         // heat_part: update of the boundary points
+    send_left,        // sending the left-most partition to the left
+    send_right,       // sending the right-most partition to the right
+    receive_left,     // waiting for the partition from the left
+    receive_right,    // waiting for the partition from the right
+    semaphore_wait    // do_work suspended, the dependency tree is too deep
+};
+
+constexpr std::uint32_t no_partition = std::uint32_t(-1);
+
+struct trace_event
+{
+    std::uint64_t begin;    // [ns] since the start of tracing
+    std::uint64_t end;
+    std::uint64_t step;
+    std::uint32_t partition;    // local partition index or no_partition
+    std::uint32_t thread;       // worker thread
+    std::uint32_t locality;
+    trace_kind kind;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        std::uint8_t k = std::uint8_t(kind);
+        ar & begin & end & step & partition & thread & locality & k;
+        kind = trace_kind(k);
+    }
+};
+
+// Start recording events on this locality, the timestamps of all events
+// are relative to this point in time.
+void start_tracing();
+
+// Record an event which has been started at 'begin'
+void record_event(trace_kind kind, std::uint64_t begin, std::size_t partition,
+    std::size_t step);
+
+// Stop recording and return all events recorded on this locality
+std::vector<trace_event> collect_trace();
+
+HPX_DEFINE_PLAIN_ACTION(collect_trace, collect_trace_action);
+HPX_REGISTER_ACTION_DECLARATION(collect_trace_action);
+
+// Write the events collected from all localities as a Chrome trace
+void write_trace(std::string const& filename,
+    std::vector<std::vector<trace_event>> const& events);
+
+///////////////////////////////////////////////////////////////////////////////
+// Record the lifetime of this object as one event, this does nothing if
+// tracing is disabled.
+class trace_scope
+{
+public:
+    trace_scope(trace_kind kind, std::size_t partition, std::size_t step)
+      : begin_(tracing ? hpx::util::high_resolution_clock::now() : 0)
+      , kind_(kind)
+      , partition_(partition)
+      , step_(step)
+    {
+    }
+
+    ~trace_scope()
+    {
+        if (begin_ != 0)
+            record_event(kind_, begin_, partition_, step_);
+    }
+
+    trace_scope(trace_scope const&) = delete;
+    trace_scope& operator=(trace_scope const&) = delete;
+
+private:
+    std::uint64_t begin_;
+    trace_kind kind_;
+    std::size_t partition_;
+    std::size_t step_;
+};
+
+#endif    // TRACE_HPP_
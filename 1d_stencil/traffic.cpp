@@ -0,0 +1,95 @@
+#include "traffic.hpp"
+
+#include <hpx/format.hpp>
+#include <hpx/hpx.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+    char const* const traffic_names[] = {"get_data_request", "get_data_left",
+        "get_data_middle", "get_data_right", "from_left", "from_right",
+        "gather", "migrate", "store_chunk"};
+
+    struct traffic_counts
+    {
+        std::uint64_t messages = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // Only a few messages are sent per time step, a single lock does not
+    // get contended.
+    hpx::lcos::local::spinlock traffic_mtx;
+    std::map<std::pair<traffic_kind, std::uint32_t>, traffic_counts> traffic;
+}
+
+void record_traffic(traffic_kind kind, std::uint32_t peer, std::uint64_t bytes)
+{
+    if (!account_traffic || peer == hpx::get_locality_id())
+        return;
+
+    std::lock_guard<hpx::lcos::local::spinlock> l(traffic_mtx);
+    traffic_counts& c = traffic[std::make_pair(kind, peer)];
+    ++c.messages;
+    c.bytes += bytes;
+}
+
+std::vector<traffic_record> collect_traffic()
+{
+    std::uint32_t const locality = hpx::get_locality_id();
+    std::vector<traffic_record> result;
+
+    std::lock_guard<hpx::lcos::local::spinlock> l(traffic_mtx);
+    for (auto const& t : traffic)
+    {
+        result.push_back(traffic_record{locality, t.first.second,
+            t.first.first, t.second.messages, t.second.bytes});
+    }
+    return result;
+}
+
+HPX_REGISTER_ACTION(collect_traffic_action);
+
+///////////////////////////////////////////////////////////////////////////////
+void print_traffic(std::vector<std::vector<traffic_record>> const& traffic,
+    std::size_t nt, bool header, std::string const& filename)
+{
+    std::ofstream file;
+    if (!filename.empty())
+    {
+        file.open(filename);
+        if (!file)
+        {
+            std::cerr << "Unable to write traffic file: " << filename
+                      << std::endl;
+            return;
+        }
+    }
+    std::ostream& out = filename.empty() ? std::cout : file;
+
+    if (header || !filename.empty())
+        out << "Locality,Action,Peer,Messages,Bytes,Messages_per_Step,"
+               "Bytes_per_Step\n";
+
+    double const steps = nt != 0 ? double(nt) : 1.0;
+    for (std::vector<traffic_record> const& records : traffic)
+    {
+        for (traffic_record const& r : records)
+        {
+            std::string peer =
+                r.peer == any_locality ? "*" : std::to_string(r.peer);
+            hpx::util::format_to(out, "{},{},{},{},{},{:.6g},{:.6g}\n",
+                r.locality, traffic_names[std::size_t(r.kind)], peer,
+                r.messages, r.bytes, r.messages / steps, r.bytes / steps);
+        }
+    }
+    out << std::flush;
+}
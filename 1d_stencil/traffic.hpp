@@ -0,0 +1,99 @@
+#if !defined(TRAFFIC_HPP_)
+#define TRAFFIC_HPP_
+
+#include "options.hpp"
+
+#include <hpx/include/actions.hpp>
+#include <hpx/include/naming.hpp>
+#include <hpx/include/serialization.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Opt-in accounting of the messages sent between the localities (see
+// --traffic). Every message is recorded by the locality sending it (the
+// replies of get_data_action by the locality serving the request), keyed by
+// the kind of message and the locality on the other end. The
+// bytes are the serialized payload as measured by serialized_size, not
+// including the parcel headers.
+enum class traffic_kind : std::uint8_t
+{
+    get_data_request,   // request of get_data_action
+    get_data_left,      // reply of get_data_action, left boundary element
+    get_data_middle,    // reply of get_data_action, whole partition
+    get_data_right,     // reply of get_data_action, right boundary element
+    from_left,          // partition sent to the right neighbor
+    from_right,         // partition sent to the left neighbor
+    gather,             // final partitions sent to locality 0
+    migrate,            // partition serialized for a migration
+    store_chunk,        // chunk of a streaming migration
+    num_kinds
+};
+
+// The destination of a migration is not known where the partition is
+// serialized.
+constexpr std::uint32_t any_locality = std::uint32_t(-1);
+
+// Return the number of bytes the given values occupy in the archive of a
+// message sending them. Large arrays are not copied but referenced by the
+// archive, as they are when a parcel is sent.
+template <typename... Ts>
+std::uint64_t serialized_size(Ts const&... values)
+{
+    std::vector<char> buffer;
+    std::vector<hpx::serialization::serialization_chunk> chunks;
+    hpx::serialization::output_archive ar(buffer, 0U, &chunks);
+
+    std::size_t const header = ar.bytes_written();
+    int const sequence[] = {0, (ar << values, 0)...};
+    (void) sequence;
+    return ar.bytes_written() - header;
+}
+
+// Serialized size of a global id. An id_type can't be serialized outside of
+// a parcel (its credits are split on the way), it is accounted as its gid and
+// its management type.
+inline std::uint64_t id_size()
+{
+    static std::uint64_t const size =
+        serialized_size(hpx::naming::gid_type(), std::uint8_t());
+    return size;
+}
+
+struct traffic_record
+{
+    std::uint32_t locality;    // sending locality
+    std::uint32_t peer;        // other end or any_locality
+    traffic_kind kind;
+    std::uint64_t messages;
+    std::uint64_t bytes;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        std::uint8_t k = std::uint8_t(kind);
+        ar & locality & peer & k & messages & bytes;
+        kind = traffic_kind(k);
+    }
+};
+
+// Record one message of 'bytes' bytes sent to 'peer', this does nothing if
+// the accounting is disabled or 'peer' is this locality.
+void record_traffic(traffic_kind kind, std::uint32_t peer, std::uint64_t bytes);
+
+// Return the traffic recorded on this locality
+std::vector<traffic_record> collect_traffic();
+
+HPX_DEFINE_PLAIN_ACTION(collect_traffic, collect_traffic_action);
+HPX_REGISTER_ACTION_DECLARATION(collect_traffic_action);
+
+// Print the traffic collected from all localities as csv, both in total and
+// per time step. If 'filename' is not empty, the csv is written to this file
+// instead.
+void print_traffic(std::vector<std::vector<traffic_record>> const& traffic,
+    std::size_t nt, bool header, std::string const& filename);
+
+#endif    // TRAFFIC_HPP_
@@ -0,0 +1,189 @@
+#if !defined(AFFINITY_HPP_)
+#define AFFINITY_HPP_
+
+#include <hpx/include/apply.hpp>
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+#include <hpx/include/naming.hpp>
+#include <hpx/include/serialization.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Parameters of the migrate-on-access policy (see affinity_tracker)
+struct affinity_policy
+{
+    std::size_t window;      // invocations per observation window
+    double share;            // part of a window the dominating caller issued
+    std::size_t sustain;     // consecutive windows it has to dominate
+    std::size_t cooldown;    // windows without a decision after a move
+};
+
+// Number of components this locality asked to follow their callers
+inline std::atomic<std::uint64_t>& affinity_migrations()
+{
+    static std::atomic<std::uint64_t> migrations(0);
+    return migrations;
+}
+
+// Number of these migrations which failed
+inline std::atomic<std::uint64_t>& affinity_failed_migrations()
+{
+    static std::atomic<std::uint64_t> failed(0);
+    return failed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Counts the invocations of one component per calling locality and decides
+// when the component should move to its callers.
+//
+// The invocations are counted in windows of 'window' calls. A window is
+// dominated by a remote locality if that locality issued at least 'share' of
+// its calls, the calls made on the locality the component lives on count
+// against all remote callers. Once the same remote locality dominated
+// 'sustain' consecutive windows the component should be migrated there. No
+// decisions are taken during the 'cooldown' windows following a move, which
+// together with requiring a sustained majority keeps components used by
+// several localities from bouncing back and forth. The tracker is serialized
+// with its component, the cooldown therefore starts on the new locality.
+class affinity_tracker
+{
+private:
+    using mutex_type = hpx::lcos::local::spinlock;
+
+    struct caller_calls
+    {
+        std::uint32_t locality;
+        std::uint64_t calls;
+
+        template <typename Archive>
+        void serialize(Archive& ar, unsigned version)
+        {
+            ar & locality & calls;
+        }
+    };
+
+public:
+    affinity_tracker() = default;
+
+    affinity_tracker(affinity_tracker const& other)
+    {
+        std::lock_guard<mutex_type> l(other.mtx_);
+        assign(other);
+    }
+
+    affinity_tracker& operator=(affinity_tracker const& other)
+    {
+        if (this != &other)
+        {
+            std::lock_guard<mutex_type> l(other.mtx_);
+            assign(other);
+        }
+        return *this;
+    }
+
+    // Record an invocation from locality 'caller' of a component living on
+    // locality 'here'. Returns the locality the component should be migrated
+    // to, hpx::naming::invalid_locality_id if it should stay.
+    std::uint32_t record(std::uint32_t caller, std::uint32_t here,
+        affinity_policy const& policy)
+    {
+        std::lock_guard<mutex_type> l(mtx_);
+
+        auto it = std::find_if(calls_.begin(), calls_.end(),
+            [caller](caller_calls const& c) { return c.locality == caller; });
+        if (it == calls_.end())
+            calls_.push_back(caller_calls{caller, 1});
+        else
+            ++it->calls;
+
+        if (++window_calls_ < (std::max)(policy.window, std::size_t(1)))
+            return hpx::naming::invalid_locality_id;
+
+        // the window is complete, find the locality which issued most calls
+        auto top = std::max_element(calls_.begin(), calls_.end(),
+            [](caller_calls const& lhs, caller_calls const& rhs) {
+                return lhs.calls < rhs.calls;
+            });
+        std::uint32_t const dominant = top->locality;
+        bool const dominated = dominant != here &&
+            double(top->calls) >= policy.share * double(window_calls_);
+
+        calls_.clear();
+        window_calls_ = 0;
+
+        if (cooldown_ != 0)
+        {
+            --cooldown_;
+            streak_ = 0;
+            return hpx::naming::invalid_locality_id;
+        }
+
+        if (!dominated || (streak_ != 0 && candidate_ != dominant))
+            streak_ = 0;
+        if (!dominated)
+            return hpx::naming::invalid_locality_id;
+
+        candidate_ = dominant;
+        if (++streak_ < policy.sustain)
+            return hpx::naming::invalid_locality_id;
+
+        streak_ = 0;
+        cooldown_ = policy.cooldown;
+        return dominant;
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned version)
+    {
+        ar & calls_ & window_calls_ & candidate_ & streak_ & cooldown_;
+    }
+
+private:
+    void assign(affinity_tracker const& other)
+    {
+        calls_ = other.calls_;
+        window_calls_ = other.window_calls_;
+        candidate_ = other.candidate_;
+        streak_ = other.streak_;
+        cooldown_ = other.cooldown_;
+    }
+
+    mutable mutex_type mtx_;
+    std::vector<caller_calls> calls_;    // calls of the current window
+    std::uint64_t window_calls_ = 0;
+    std::uint32_t candidate_ = hpx::naming::invalid_locality_id;
+    std::uint64_t streak_ = 0;      // windows dominated by 'candidate_'
+    std::uint64_t cooldown_ = 0;    // windows left without a decision
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Migrate the component 'id' to locality 'target' without waiting for it.
+// The migration starts once the invocation which triggered it has returned.
+// A component which cannot be migrated (e.g. as it is destroyed in the
+// meantime) stays where it is, the failure is counted only.
+template <typename Component>
+void migrate_to_caller(hpx::id_type const& id, std::uint32_t target)
+{
+    ++affinity_migrations();
+    hpx::apply([id, target]() {
+        try
+        {
+            hpx::components::migrate<Component>(
+                id, hpx::naming::get_id_from_locality_id(target))
+                .get();
+        }
+        catch (std::exception const&)
+        {
+            ++affinity_failed_migrations();
+        }
+    });
+}
+
+#endif    // AFFINITY_HPP_
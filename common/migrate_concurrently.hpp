@@ -0,0 +1,45 @@
+#if !defined(MIGRATE_CONCURRENTLY_HPP_)
+#define MIGRATE_CONCURRENTLY_HPP_
+
+#include <hpx/include/components.hpp>
+#include <hpx/include/lcos.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Migrate many components at once. All migrations are issued back to back
+// without waiting for each other, so that the state transfers and the
+// corresponding AGAS updates are in flight concurrently. No batching is
+// done: every component is transferred and re-registered with AGAS by a
+// migration of its own, even if several of them move to the same target.
+// The returned future becomes ready once all components have arrived, the
+// clients are returned in the order of the input pairs.
+template <typename Client>
+hpx::future<std::vector<Client>> migrate_concurrently(
+    std::vector<std::pair<Client, hpx::id_type>> const& moves)
+{
+    std::vector<Client> result;
+    result.reserve(moves.size());
+
+    std::vector<hpx::shared_future<hpx::id_type>> ids;
+    ids.reserve(moves.size());
+
+    for (auto const& move : moves)
+    {
+        result.push_back(hpx::components::migrate(move.first, move.second));
+        ids.push_back(result.back().share());
+    }
+
+    return hpx::when_all(std::move(ids)).then(
+        [result = std::move(result)](
+            hpx::future<std::vector<hpx::shared_future<hpx::id_type>>>&&
+                f) mutable {
+            for (auto& id : f.get())
+                id.get();    // propagate exceptions
+            return std::move(result);
+        });
+}
+
+#endif    // MIGRATE_CONCURRENTLY_HPP_
@@ -6,15 +6,20 @@
 
 #include <hpx/hpx_init.hpp>
 
+#include "affinity.hpp"
+#include "migrate_concurrently.hpp"
+
 #include <hpx/hpx_main.hpp>
 #include <hpx/include/actions.hpp>
 #include <hpx/include/components.hpp>
 #include <hpx/include/iostreams.hpp>
 #include <hpx/include/lcos.hpp>
 #include <hpx/include/serialization.hpp>
+#include <hpx/include/util.hpp>
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -22,6 +27,11 @@ template <typename T>
 using migratable_component_base =
     hpx::components::migration_support<hpx::components::component_base<T>>;
 
+// Components follow the locality invoking them most (see affinity_tracker),
+// this is set on every locality by --migrate-on-access
+bool migrate_on_access = false;
+affinity_policy affinity = {16, 0.75, 2, 8};
+
 ///////////////////////////////////////////////////////////////////////////////
 class mgcex_srv : public migratable_component_base<mgcex_srv>
 {
@@ -35,28 +45,40 @@ public:
     mgcex_srv(mgcex_srv const& other)
       : base_type(other)
       , data_(other.data_)
+      , affinity_(other.affinity_)
     {
     }
     mgcex_srv& operator=(mgcex_srv const& other)
     {
         data_ = other.data_;
+        affinity_ = other.affinity_;
         return *this;
     }
     mgcex_srv(mgcex_srv&& other)
       : base_type(std::move(other))
       , data_(other.data_)
+      , affinity_(other.affinity_)
     {
     }
     mgcex_srv& operator=(mgcex_srv&& other)
     {
         data_ = other.data_;
+        affinity_ = other.affinity_;
         return *this;
     }
     ~mgcex_srv() = default;
 
-    hpx::id_type call() const
+    // 'caller' is the locality invoking this action
+    hpx::id_type call(std::uint32_t caller) const
     {
         HPX_ASSERT(pin_count() != 0);
+        if (migrate_on_access)
+        {
+            std::uint32_t const target =
+                affinity_.record(caller, hpx::get_locality_id(), affinity);
+            if (target != hpx::naming::invalid_locality_id)
+                migrate_to_caller<mgcex_srv>(get_id(), target);
+        }
         return hpx::find_here();
     }
     HPX_DEFINE_COMPONENT_ACTION(mgcex_srv, call);
@@ -111,11 +133,12 @@ public:
     template <typename Archive>
     void serialize(Archive& ar, unsigned version)
     {
-        ar & data_;
+        ar & data_ & affinity_;
     }
 
 private:
     int data_;
+    mutable affinity_tracker affinity_;
 };
 
 using bas_mig_server_t = hpx::components::component<mgcex_srv>;
@@ -154,7 +177,8 @@ public:
     }
 
     hpx::id_type call() const {
-        return mgcex_srv::call_action()(this->get_id());
+        return mgcex_srv::call_action()(
+            this->get_id(), hpx::get_locality_id());
     }
 
     //hpx::future<void> busy_work() const
@@ -179,17 +203,42 @@ public:
 };
 
 
-///////////////////////////////////////////////////////////////////////////////
-void migrate_component(hpx::id_type src, hpx::id_type target)
+void do_all_work(std::size_t nc)
 {
-    auto t1 = hpx::new_<mgcex_client>(src, 42);
+    std::vector<hpx::id_type> localities = hpx::find_remote_localities();
 
-    HPX_ASSERT(t1.call() == src);
-    //HPX_ASSERT(t1.get_data() == 42);
+    HPX_ASSERT(!localities.empty());
+
+    hpx::id_type here = hpx::find_here();
+
+    // create 'nc' components per remote locality here, they all get moved
+    // to their target concurrently, each by a migration of its own
+    std::vector<std::pair<mgcex_client, hpx::id_type>> moves;
+    moves.reserve(nc * localities.size());
+    for (auto const& id : localities)
+    {
+        for (std::size_t i = 0; i != nc; ++i)
+        {
+            moves.emplace_back(hpx::new_<mgcex_client>(here, 42), id);
+        }
+    }
+
+    std::uint64_t t = hpx::util::high_resolution_clock::now();
 
     try
     {
-        mgcex_client t2(hpx::components::migrate(t1, target));
+        std::vector<mgcex_client> migrated =
+            migrate_concurrently(moves).get();
+
+        std::uint64_t elapsed = hpx::util::high_resolution_clock::now() - t;
+
+        for (std::size_t i = 0; i != migrated.size(); ++i)
+        {
+            HPX_ASSERT(migrated[i].call() == moves[i].second);
+        }
+
+        hpx::cout << "migrated " << migrated.size() << " components in "
+                  << elapsed / 1e9 << " [s]" << hpx::endl;
     }
     catch (std::exception const& ex)
     {
@@ -197,16 +246,41 @@ void migrate_component(hpx::id_type src, hpx::id_type target)
     }
 }
 
-void do_all_work()
+///////////////////////////////////////////////////////////////////////////////
+// Invoke the component 'id' 'n' times from this locality
+void call_repeatedly(hpx::id_type const& id, std::size_t n)
+{
+    mgcex_client c(hpx::id_type(id));
+    for (std::size_t i = 0; i != n; ++i)
+    {
+        c.call();
+    }
+}
+HPX_PLAIN_ACTION(call_repeatedly, call_repeatedly_action);
+
+// Create a component here and invoke it 'n' times from the first remote
+// locality, with --migrate-on-access the component is expected to follow
+// its caller.
+void follow_caller(std::size_t n)
 {
     std::vector<hpx::id_type> localities = hpx::find_remote_localities();
 
     HPX_ASSERT(!localities.empty());
 
-    for (auto const& id : localities)
-    {
-        migrate_component(hpx::find_here(), id);
-    }
+    auto t = hpx::new_<mgcex_client>(hpx::find_here(), 42);
+    call_repeatedly_action()(localities[0], t.get_id(), n);
+
+    // the migration is started asynchronously, the invocation below is
+    // delivered to the component once it has arrived
+    hpx::id_type where = t.call();
+
+    hpx::cout << "component invoked " << n << " times from locality "
+              << hpx::naming::get_locality_id_from_id(localities[0])
+              << " lives on locality "
+              << hpx::naming::get_locality_id_from_id(where) << " ("
+              << affinity_migrations() << " migrations requested, "
+              << affinity_failed_migrations() << " failed)"
+              << hpx::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -219,7 +293,12 @@ int hpx_main(boost::program_options::variables_map& vm)
     //vm.count("no-header")
     //vm.count("results")
 
-    do_all_work();
+    std::size_t nc = vm["nc"].as<std::size_t>();    // Components per target.
+    std::size_t ncalls = vm["follow-calls"].as<std::size_t>();
+
+    do_all_work(nc);
+    if (ncalls != 0)
+        follow_caller(ncalls);
     //do_all_work(nt, nx, np, nd);
 
     return hpx::finalize();
@@ -230,6 +309,33 @@ int main(int argc, char* argv[])
     using namespace boost::program_options;
 
     options_description desc_commandline;
+    desc_commandline.add_options()
+        ("nc", value<std::size_t>()->default_value(1),
+         "Number of components to migrate to each remote locality")
+        ("migrate-on-access", bool_switch(&migrate_on_access),
+         "migrate the components to the locality invoking them most once it "
+         "did so for --affinity-sustain consecutive windows")
+        ("follow-calls", value<std::size_t>()->default_value(0),
+         "Invoke a component created on this locality the given number of "
+         "times from a remote locality, with --migrate-on-access the "
+         "component follows its caller (default: 0, do not run)")
+        ("affinity-window", value<std::size_t>(&affinity.window)
+            ->default_value(16),
+         "Number of invocations per observation window of a component "
+         "(default: 16)")
+        ("affinity-share", value<double>(&affinity.share)
+            ->default_value(0.75),
+         "Share of the invocations of a window a remote locality has to "
+         "issue to dominate it (default: 0.75)")
+        ("affinity-sustain", value<std::size_t>(&affinity.sustain)
+            ->default_value(2),
+         "Number of consecutive windows the same locality has to dominate "
+         "before the component is migrated (default: 2)")
+        ("affinity-cooldown", value<std::size_t>(&affinity.cooldown)
+            ->default_value(8),
+         "Number of windows after a migration during which the component "
+         "stays where it is (default: 8)")
+    ;
     //desc_commandline.add_options()
     //    ("results", "print generated results (default: false)")
     //    ("nx", value<std::uint64_t>()->default_value(10),